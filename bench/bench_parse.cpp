@@ -0,0 +1,283 @@
+// Runtime parse of small nested JSON and YAML configs into the default document,
+// of a larger pretty-printed JSON payload dominated by strings and indentation
+// (also into a pmr document on a reused monotonic buffer, and fed to the
+// stream parser in 4 KB chunks),
+// of a ~10 MB YAML file that is mostly comments and indentation, of a
+// JSON table of floats and one of integers, and of JSON strings dense with
+// escapes
+
+#include <immutable_data/json.hpp>
+#include <immutable_data/yaml.hpp>
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace
+{
+    constexpr std::string_view json_config = R"({
+  "service": {"name": "gateway", "replicas": 3, "debug": false},
+  "listen": [{"host": "0.0.0.0", "port": 8080}, {"host": "::", "port": 8443}],
+  "routes": [
+    {"path": "/api", "upstream": "api", "timeout": 2.5, "methods": ["GET", "POST"]},
+    {"path": "/static", "upstream": "cdn", "timeout": 10.0, "methods": ["GET"]},
+    {"path": "/admin", "upstream": "admin", "timeout": 1.0, "methods": ["GET", "PUT", "DELETE"]}
+  ],
+  "limits": {"connections": 1024, "body": 1048576, "headers": 64, "rate": [100, 200, 400, 800]}
+})";
+
+    constexpr std::string_view yaml_config = R"(
+service:
+  name: gateway
+  replicas: 3
+  debug: false
+listen:
+  - host: "0.0.0.0"
+    port: 8080
+  - host: "::"
+    port: 8443
+routes:
+  - path: "/api"
+    upstream: api
+    timeout: 2.5
+    methods: [GET, POST]
+  - path: "/static"
+    upstream: cdn
+    timeout: 10.0
+    methods: [GET]
+  - path: "/admin"
+    upstream: admin
+    timeout: 1.0
+    methods: [GET, PUT, DELETE]
+limits:
+  connections: 1024
+  body: 1048576
+  headers: 64
+  rate: [100, 200, 400, 800]
+)";
+
+    template <typename Format>
+    void parse_config(benchmark::State &state, std::string_view input)
+    {
+        for (auto _ : state)
+        {
+            auto r = Format::template parse<data::detail::document>(input);
+            benchmark::DoNotOptimize(r);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+    }
+
+    // ~130 KB: 200 objects of short and long strings, one escape in ten
+    auto make_json_payload() -> std::string
+    {
+        std::string out = "[\n";
+        for (int i = 0; i < 200; ++i)
+        {
+            out += i ? ",\n" : "";
+            out += "    {\n        \"id\": " + std::to_string(i) + ",\n";
+            out += "        \"name\": \"service-" + std::to_string(i) + "-" + std::string(48, 'n') + "\",\n";
+            out += "        \"description\": \"" + std::string(400, 'd') + (i % 10 ? "" : "\\n") + "\",\n";
+            out += "        \"tags\": [\"alpha\", \"beta\"]\n    }";
+        }
+        return out + "\n]\n";
+    }
+
+    using payload_document = data::detail::basic_document<2048, 4096>;
+
+    void parse_json_payload(benchmark::State &state)
+    {
+        auto const input = make_json_payload();
+        for (auto _ : state)
+        {
+            auto r = data::json::detail::format::parse<payload_document>(input);
+            benchmark::DoNotOptimize(r);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+    }
+
+    void parse_json_payload_pmr(benchmark::State &state)
+    {
+        auto const input = make_json_payload();
+        static std::array<std::byte, 1 << 18> buffer;
+        for (auto _ : state)
+        {
+            std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size()};
+            auto r = data::json::parse(input, &resource);
+            benchmark::DoNotOptimize(r);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+    }
+
+    void parse_json_payload_stream(benchmark::State &state)
+    {
+        auto const input = make_json_payload();
+        static std::array<std::byte, 1 << 18> buffer;
+        for (auto _ : state)
+        {
+            std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size()};
+            data::json::stream_parser p{&resource};
+            for (std::size_t i = 0; i < input.size(); i += 4096)
+                p.feed(std::span{std::string_view{input}.substr(i, 4096)});
+            benchmark::DoNotOptimize(p.finish());
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+    }
+
+    // ~10 MB: 4500 sequence entries, each under a banner comment with indented
+    // notes and a literal block — the shape of large hand-maintained configs
+    auto make_yaml_payload() -> std::string
+    {
+        std::string const banner = "# " + std::string(76, '-') + "\n";
+        std::string const note = "    # " + std::string(64, 'c') + "\n";
+        std::string out;
+        for (int i = 0; i < 4500; ++i)
+        {
+            for (int j = 0; j < 12; ++j)
+                out += banner;
+            out += "- name: section_" + std::to_string(i) + "\n";
+            for (int j = 0; j < 16; ++j)
+                out += note;
+            out += "  enabled: true\n";
+            out += "  notes: |\n";
+            out += "      first line of notes for this section\n";
+            out += "\n";
+            out += "      second line, after a blank one\n";
+            out += "\n\n";
+        }
+        return out;
+    }
+
+    using yaml_payload_document = data::detail::basic_document<32768, 1 << 20, 64>;
+
+    // bytes per time-stamp-counter cycle is reported where there is one
+    void parse_yaml_payload(benchmark::State &state)
+    {
+        auto const input = make_yaml_payload();
+#if defined(__x86_64__) || defined(__i386__)
+        std::uint64_t cycles = 0;
+#endif
+        for (auto _ : state)
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            auto const start = __rdtsc();
+#endif
+            auto r = data::yaml::detail::format::parse<yaml_payload_document>(input);
+            benchmark::DoNotOptimize(r);
+#if defined(__x86_64__) || defined(__i386__)
+            cycles += __rdtsc() - start;
+#endif
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+#if defined(__x86_64__) || defined(__i386__)
+        state.counters["bytes_per_cycle"] = static_cast<double>(state.iterations() * input.size()) / static_cast<double>(cycles);
+#endif
+    }
+
+    // a 64x16 calibration table of full-precision doubles
+    auto make_calibration_table() -> std::string
+    {
+        std::string out = "[\n";
+        for (int row = 0; row < 64; ++row)
+        {
+            out += row ? ",\n    [" : "    [";
+            for (int col = 0; col < 16; ++col)
+            {
+                out += col ? ", " : "";
+                out += std::to_string(row * 16 + col) + "." + std::to_string(123456789 + row * 7919 + col * 104729) + "e-" + std::to_string(col % 9);
+            }
+            out += "]";
+        }
+        return out + "\n]\n";
+    }
+
+    using table_document = data::detail::basic_document<2048, 0>;
+
+    void parse_json_numbers(benchmark::State &state)
+    {
+        auto const input = make_calibration_table();
+        for (auto _ : state)
+        {
+            auto r = data::json::detail::format::parse<table_document>(input);
+            benchmark::DoNotOptimize(r);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+    }
+
+    // 1024 integers from 1 to 19 digits: counters, ids, nanosecond timestamps
+    auto make_integer_table() -> std::string
+    {
+        std::string out = "[";
+        std::uint64_t x = 0x9E3779B97F4A7C15;
+        for (int i = 0; i < 1024; ++i)
+        {
+            x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+            out += i ? ", " : "";
+            out += std::to_string((x >> 1) >> (x % 60));
+        }
+        return out + "]\n";
+    }
+
+    void parse_json_integers(benchmark::State &state)
+    {
+        auto const input = make_integer_table();
+        for (auto _ : state)
+        {
+            auto r = data::json::detail::format::parse<table_document>(input);
+            benchmark::DoNotOptimize(r);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+    }
+
+    // ~200 KB: PEM certificates (an escaped line break every 64 characters)
+    // and HTML templates with escaped quotes and non-ASCII text
+    auto make_escaped_payload() -> std::string
+    {
+        std::string out = "[\n";
+        for (int i = 0; i < 100; ++i)
+        {
+            out += i ? ",\n" : "";
+            out += "    {\"cert\": \"-----BEGIN CERTIFICATE-----\\n";
+            for (int line = 0; line < 20; ++line)
+                out += std::string(64, static_cast<char>('A' + (i + line) % 26)) + "\\n";
+            out += "-----END CERTIFICATE-----\\n\",\n";
+            out += "     \"template\": \"<div class=\\\"card-" + std::to_string(i) + "\\\">\\n\\t<p>Caf\\u00e9 " + std::string(200, 't') + "</p>\\n</div>\"}";
+        }
+        return out + "\n]\n";
+    }
+
+    using escaped_document = data::detail::basic_document<1024, 1 << 18>;
+
+    void parse_json_escaped(benchmark::State &state)
+    {
+        auto const input = make_escaped_payload();
+        for (auto _ : state)
+        {
+            auto r = data::json::detail::format::parse<escaped_document>(input);
+            benchmark::DoNotOptimize(r);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+    }
+
+    void parse_json(benchmark::State &state) { parse_config<data::json::detail::format>(state, json_config); }
+    void parse_yaml(benchmark::State &state) { parse_config<data::yaml::detail::format>(state, yaml_config); }
+
+} // namespace
+
+BENCHMARK(parse_json);
+BENCHMARK(parse_yaml);
+BENCHMARK(parse_json_payload);
+BENCHMARK(parse_json_payload_pmr);
+BENCHMARK(parse_json_payload_stream);
+BENCHMARK(parse_json_numbers);
+BENCHMARK(parse_json_integers);
+BENCHMARK(parse_json_escaped);
+BENCHMARK(parse_yaml_payload)->Unit(benchmark::kMillisecond);
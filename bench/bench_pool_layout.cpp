@@ -0,0 +1,180 @@
+// Lookup and iteration over the document's struct-of-arrays pool, against the
+// previous array-of-structs layout (one pool_entry per child), and lookup
+// through a mapping's perfect-hash index or sorted key order, with the key
+// hashed per call or once up front (data::key)
+
+#include <immutable_data/detail/types.hpp>
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace data::detail;
+
+    constexpr std::size_t MAX_CHILDREN = 4096;
+
+    // previous layout: keys and values interleaved in one array
+    struct aos_document
+    {
+        std::array<pool_entry, MAX_CHILDREN> pool_{};
+        std::size_t pool_size_{0};
+
+        auto push(pool_entry const &e) noexcept -> void { pool_[pool_size_++] = e; }
+
+        auto find(value const &v, std::string_view key) const noexcept -> value const *
+        {
+            if (v.kind_ != value::kind::mapping)
+                return nullptr;
+            for (std::size_t i = 0; i < v.data_.children_.count; ++i)
+            {
+                auto &entry = pool_[v.data_.children_.start + i];
+                if (entry.key.view() == key)
+                    return &entry.val_;
+            }
+            return nullptr;
+        }
+
+        auto values(value const &v) const noexcept -> std::pair<pool_entry const *, pool_entry const *>
+        {
+            auto *base = pool_.data() + v.data_.children_.start;
+            return {base, base + v.data_.children_.count};
+        }
+    };
+
+    using soa_document = basic_document<MAX_CHILDREN, 0>;
+    using sorted_document = basic_document<MAX_CHILDREN, 0, MAX_CHILDREN * 2 + 1, 0, true>;
+
+    auto make_keys(std::size_t n) -> std::vector<std::string>
+    {
+        std::vector<std::string> keys;
+        for (std::size_t i = 0; i < n; ++i)
+            keys.push_back("key_" + std::to_string(i));
+        return keys;
+    }
+
+    // one mapping of `n` integer children, keyed by `keys`
+    template <typename Document>
+    auto make_mapping(Document &doc, std::vector<std::string> const &keys) -> value
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            doc.push(pool_entry{source_ref(keys[i]), value::make_int(static_cast<std::int64_t>(i))});
+        }
+        return value::make_mapping(0, keys.size());
+    }
+
+    // the same mapping built the way the parsers build it — with a hash
+    // index, or sorted by key for sorted_document
+    template <typename Document>
+    auto make_indexed_mapping(Document &doc, std::vector<std::string> const &keys) -> value
+    {
+        auto const mark = doc.top_;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            (void)doc.stage(source_ref(keys[i]), value::make_int(static_cast<std::int64_t>(i)));
+        return *doc.finish_mapping(mark);
+    }
+
+    void find_aos(benchmark::State &state)
+    {
+        auto keys = make_keys(static_cast<std::size_t>(state.range(0)));
+        auto doc = std::make_unique<aos_document>();
+        auto root = make_mapping(*doc, keys);
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(doc->find(root, keys[next]));
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void find_soa(benchmark::State &state)
+    {
+        auto keys = make_keys(static_cast<std::size_t>(state.range(0)));
+        auto doc = std::make_unique<soa_document>();
+        auto root = make_mapping(*doc, keys);
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(doc->find(root, keys[next]));
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template <typename Document>
+    void find_indexed(benchmark::State &state)
+    {
+        auto keys = make_keys(static_cast<std::size_t>(state.range(0)));
+        auto doc = std::make_unique<Document>();
+        auto root = make_indexed_mapping(*doc, keys);
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(doc->find(root, keys[next]));
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template <typename Document>
+    void find_prehashed(benchmark::State &state)
+    {
+        auto keys = make_keys(static_cast<std::size_t>(state.range(0)));
+        std::vector<data::key> handles(keys.begin(), keys.end());
+        auto doc = std::make_unique<Document>();
+        auto root = make_indexed_mapping(*doc, keys);
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(doc->find(root, handles[next]));
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void iterate_aos(benchmark::State &state)
+    {
+        auto keys = make_keys(static_cast<std::size_t>(state.range(0)));
+        auto doc = std::make_unique<aos_document>();
+        auto root = make_mapping(*doc, keys);
+        for (auto _ : state)
+        {
+            std::int64_t sum = 0;
+            auto [begin, end] = doc->values(root);
+            for (auto *p = begin; p != end; ++p)
+                sum += p->val_.as_int();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void iterate_soa(benchmark::State &state)
+    {
+        auto keys = make_keys(static_cast<std::size_t>(state.range(0)));
+        auto doc = std::make_unique<soa_document>();
+        auto root = make_mapping(*doc, keys);
+        for (auto _ : state)
+        {
+            std::int64_t sum = 0;
+            for (auto const &v : doc->values(root))
+                sum += v.as_int();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+} // namespace
+
+BENCHMARK(find_aos)->RangeMultiplier(4)->Range(16, MAX_CHILDREN);
+BENCHMARK(find_soa)->RangeMultiplier(4)->Range(16, MAX_CHILDREN);
+BENCHMARK(find_indexed<soa_document>)->RangeMultiplier(4)->Range(16, MAX_CHILDREN);
+BENCHMARK(find_indexed<sorted_document>)->RangeMultiplier(4)->Range(16, MAX_CHILDREN);
+BENCHMARK(find_prehashed<soa_document>)->RangeMultiplier(4)->Range(16, MAX_CHILDREN);
+BENCHMARK(find_prehashed<sorted_document>)->RangeMultiplier(4)->Range(16, MAX_CHILDREN);
+BENCHMARK(iterate_aos)->RangeMultiplier(4)->Range(16, MAX_CHILDREN);
+BENCHMARK(iterate_soa)->RangeMultiplier(4)->Range(16, MAX_CHILDREN);
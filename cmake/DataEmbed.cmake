@@ -21,16 +21,12 @@ function(_data_round_up_pow2 INPUT OUTPUT)
     set(${OUTPUT} ${_pow} PARENT_SCOPE)
 endfunction()
 
-# Analyze a data file and compute capacity requirements
-function(_data_analyze_file DATA_FILE OUT_TOKENS OUT_ITEMS OUT_STRING OUT_NODES)
+# Analyze a data file and compute parser scratch requirements. Token, node
+# and arena capacities need no estimate — embedded files are parsed with
+# parse_or_throw<"...">(), which sizes them from the file itself.
+function(_data_analyze_file DATA_FILE OUT_ITEMS OUT_STRING)
     file(READ "${DATA_FILE}" CONTENT)
 
-    # Count lines → approximate token count
-    string(REGEX MATCHALL "\n" NEWLINES "${CONTENT}")
-    list(LENGTH NEWLINES LINE_COUNT)
-    math(EXPR LINE_COUNT "${LINE_COUNT} + 1")
-    math(EXPR TOKEN_EST "${LINE_COUNT} * 4 + 8")
-
     # Count mapping entries (colons not inside quotes)
     string(REGEX MATCHALL "[a-zA-Z0-9_\"]+:" COLONS "${CONTENT}")
     list(LENGTH COLONS COLON_COUNT)
@@ -43,9 +39,6 @@ function(_data_analyze_file DATA_FILE OUT_TOKENS OUT_ITEMS OUT_STRING OUT_NODES)
         math(EXPR DASH_COUNT "${DASH_COUNT} + 1")
     endif()
 
-    # Total nodes
-    math(EXPR TOTAL_NODES "${COLON_COUNT} + ${DASH_COUNT} + 4")
-
     # Max items per level
     if(COLON_COUNT GREATER DASH_COUNT)
         set(ITEMS_EST ${COLON_COUNT})
@@ -66,15 +59,11 @@ function(_data_analyze_file DATA_FILE OUT_TOKENS OUT_ITEMS OUT_STRING OUT_NODES)
     math(EXPR STRING_EST "${MAX_LINE_LEN} + 16")
 
     # Round up to powers of 2
-    _data_round_up_pow2(${TOKEN_EST} TOKEN_POW2)
     _data_round_up_pow2(${ITEMS_EST} ITEMS_POW2)
     _data_round_up_pow2(${STRING_EST} STRING_POW2)
-    _data_round_up_pow2(${TOTAL_NODES} NODES_POW2)
 
-    set(${OUT_TOKENS} ${TOKEN_POW2} PARENT_SCOPE)
     set(${OUT_ITEMS} ${ITEMS_POW2} PARENT_SCOPE)
     set(${OUT_STRING} ${STRING_POW2} PARENT_SCOPE)
-    set(${OUT_NODES} ${NODES_POW2} PARENT_SCOPE)
 endfunction()
 
 function(data_embed TARGET)
@@ -82,10 +71,8 @@ function(data_embed TARGET)
     file(MAKE_DIRECTORY "${OUTPUT_DIR}")
 
     # Track max sizes across all files for this target
-    set(MAX_TOKENS 16)
     set(MAX_ITEMS 16)
     set(MAX_STRING 16)
-    set(MAX_NODES 16)
 
     foreach(DATA_FILE ${ARGN})
         get_filename_component(FILE_ABSOLUTE "${DATA_FILE}" ABSOLUTE)
@@ -111,21 +98,15 @@ function(data_embed TARGET)
         set(OUTPUT_FILE "${OUTPUT_DIR}/${FILE_NAME}.hpp")
 
         # Analyze this file
-        _data_analyze_file("${FILE_ABSOLUTE}" FILE_TOKENS FILE_ITEMS FILE_STRING FILE_NODES)
+        _data_analyze_file("${FILE_ABSOLUTE}" FILE_ITEMS FILE_STRING)
 
         # Update maximums
-        if(FILE_TOKENS GREATER MAX_TOKENS)
-            set(MAX_TOKENS ${FILE_TOKENS})
-        endif()
         if(FILE_ITEMS GREATER MAX_ITEMS)
             set(MAX_ITEMS ${FILE_ITEMS})
         endif()
         if(FILE_STRING GREATER MAX_STRING)
             set(MAX_STRING ${FILE_STRING})
         endif()
-        if(FILE_NODES GREATER MAX_NODES)
-            set(MAX_NODES ${FILE_NODES})
-        endif()
 
         add_custom_command(
             OUTPUT "${OUTPUT_FILE}"
@@ -145,13 +126,11 @@ function(data_embed TARGET)
         target_sources(${TARGET} PRIVATE "${OUTPUT_FILE}")
     endforeach()
 
-    message(STATUS "data_embed(${TARGET}): TOKENS=${MAX_TOKENS} ITEMS=${MAX_ITEMS} STRING=${MAX_STRING} NODES=${MAX_NODES}")
+    message(STATUS "data_embed(${TARGET}): ITEMS=${MAX_ITEMS} STRING=${MAX_STRING}")
 
     target_compile_definitions(${TARGET} PRIVATE
-        DATA_CT_MAX_TOKENS=${MAX_TOKENS}
         DATA_CT_MAX_ITEMS=${MAX_ITEMS}
         DATA_CT_MAX_STRING_SIZE=${MAX_STRING}
-        DATA_CT_MAX_NODES=${MAX_NODES}
     )
     target_include_directories(${TARGET} PRIVATE "${OUTPUT_DIR}")
 endfunction()
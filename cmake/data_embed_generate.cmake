@@ -38,8 +38,8 @@ file(WRITE "${DATA_OUTPUT}"
 
 namespace data::embedded {
 
-inline constexpr auto ${CPP_IDENT} = ${PARSE_FUNC}(
-R\"__data__(${DATA_CONTENT})__data__\");
+inline constexpr auto ${CPP_IDENT} = ${PARSE_FUNC}<
+R\"__data__(${DATA_CONTENT})__data__\">();
 
 } // namespace data::embedded
 ")
@@ -0,0 +1,186 @@
+#pragma once
+
+// Backslash escapes of JSON strings, TOML basic strings and YAML
+// double-quoted scalars, decoded by one routine. Runs without a backslash
+// are copied whole — found with the SIMD scanner at runtime — and every
+// \u-style escape, surrogate pairs included, goes through one UTF-8 encoder.
+
+#include <immutable_data/detail/simd.hpp>
+#include <immutable_data/detail/utils.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace data::detail
+{
+
+    enum class escape_dialect : std::uint8_t
+    {
+        json, // \" \\ \/ \b \f \n \r \t \uXXXX
+        toml, // \" \\ \b \f \n \r \t \uXXXX \UXXXXXXXX
+        yaml, // the above, \0 \a \v \e \xXX \N \_ \L \P, escaped space, tab and line break
+    };
+
+    // arena room to reserve for decoding `size` source bytes: only YAML's
+    // \L and \P grow (two bytes to three)
+    template <escape_dialect Dialect>
+    constexpr auto max_decoded_size(std::size_t size) noexcept -> std::size_t
+    {
+        return Dialect == escape_dialect::yaml ? size + size / 2 : size;
+    }
+
+    // index of the first '\\' at or after `pos`, or raw.size()
+    constexpr auto find_escape(std::string_view raw, std::size_t pos = 0) noexcept -> std::size_t
+    {
+        if !consteval
+        {
+            return find_backslash(raw, pos);
+        }
+        while (pos < raw.size() && raw[pos] != '\\')
+            ++pos;
+        return pos;
+    }
+
+    // `count` hex digits starting at raw[i]
+    constexpr auto read_hex(std::string_view raw, std::size_t i, std::size_t count) noexcept -> std::optional<std::uint32_t>
+    {
+        if (raw.size() - i < count)
+            return std::nullopt;
+        std::uint32_t v = 0;
+        for (auto const c : raw.substr(i, count))
+        {
+            if (!is_hex(c))
+                return std::nullopt;
+            v = v << 4 | hex_value(c);
+        }
+        return v;
+    }
+
+    // one code point as UTF-8; false for surrogates and past U+10FFFF
+    template <typename Sink>
+    constexpr auto append_utf8(Sink &out, std::uint32_t cp) noexcept -> bool
+    {
+        if (cp < 0x80)
+        {
+            out.append(static_cast<char>(cp));
+        }
+        else if (cp < 0x800)
+        {
+            out.append(static_cast<char>(0xC0 | (cp >> 6)));
+            out.append(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else if (cp < 0x10000)
+        {
+            if (cp >= 0xD800 && cp <= 0xDFFF)
+                return false;
+            out.append(static_cast<char>(0xE0 | (cp >> 12)));
+            out.append(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else if (cp <= 0x10FFFF)
+        {
+            out.append(static_cast<char>(0xF0 | (cp >> 18)));
+            out.append(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.append(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // decode the body of a quoted string, its first backslash at `escape`,
+    // into `out` (which has max_decoded_size() room). Returns the offset in
+    // `raw` of the first malformed escape, or npos.
+    template <escape_dialect Dialect, typename Sink>
+    constexpr auto decode_escapes(std::string_view raw, std::size_t escape, Sink &out) noexcept -> std::size_t
+    {
+        constexpr bool json = Dialect == escape_dialect::json;
+        constexpr bool yaml = Dialect == escape_dialect::yaml;
+        std::size_t i = 0;
+        while (true)
+        {
+            out.append(raw.substr(i, escape - i));
+            if (escape == raw.size())
+                return std::string_view::npos;
+            if (escape + 1 == raw.size())
+                return escape;
+            auto const c = raw[escape + 1];
+            i = escape + 2;
+
+            bool ok = true;
+            switch (c)
+            {
+            case '"':  out.append('"');  break;
+            case '\\': out.append('\\'); break;
+            case 'b':  out.append('\b'); break;
+            case 'f':  out.append('\f'); break;
+            case 'n':  out.append('\n'); break;
+            case 'r':  out.append('\r'); break;
+            case 't':  out.append('\t'); break;
+            case '/':
+                ok = Dialect != escape_dialect::toml;
+                out.append('/');
+                break;
+            case 'u':
+            case 'U':
+            case 'x':
+            {
+                auto const digits = c == 'x' ? 2u : c == 'u' ? 4u : 8u;
+                auto cp = (c == 'U' && json) || (c == 'x' && !yaml) ? std::nullopt : read_hex(raw, i, digits);
+                if (!cp)
+                    return escape;
+                i += digits;
+                // a high surrogate takes the low one of a following \u
+                if (*cp >= 0xD800 && *cp <= 0xDBFF && raw.substr(i, 2) == "\\u")
+                {
+                    auto const low = read_hex(raw, i + 2, 4);
+                    if (low && *low >= 0xDC00 && *low <= 0xDFFF)
+                    {
+                        cp = 0x10000 + ((*cp - 0xD800) << 10) + (*low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                ok = append_utf8(out, *cp);
+                break;
+            }
+            default:
+                ok = false;
+                if constexpr (yaml)
+                {
+                    ok = true;
+                    switch (c)
+                    {
+                    case '0':  out.append('\0');   break;
+                    case 'a':  out.append('\a');   break;
+                    case 'v':  out.append('\v');   break;
+                    case 'e':  out.append('\x1B'); break;
+                    case ' ':  out.append(' ');    break;
+                    case '\t': out.append('\t');   break;
+                    case 'N':  append_utf8(out, 0x85);   break;
+                    case '_':  append_utf8(out, 0xA0);   break;
+                    case 'L':  append_utf8(out, 0x2028); break;
+                    case 'P':  append_utf8(out, 0x2029); break;
+                    case '\n':
+                        // an escaped line break joins the lines: the break and
+                        // the next line's indentation are dropped
+                        while (i < raw.size() && is_class(raw[i], char_class::blank))
+                            ++i;
+                        break;
+                    default:
+                        ok = false;
+                        break;
+                    }
+                }
+                break;
+            }
+            if (!ok)
+                return escape;
+            escape = find_escape(raw, i);
+        }
+    }
+
+} // namespace data::detail
@@ -0,0 +1,98 @@
+#pragma once
+
+// Exact-size documents — the source is a template argument, so it can be
+// parsed once to measure it and again into a document sized to fit
+
+#include <immutable_data/detail/types.hpp>
+#include <array>
+#include <string_view>
+#include <variant>
+
+namespace data::detail
+{
+
+    // Format provides `parse<Document, Opts>(std::string_view)`; Opts
+    // selects the document layout and is passed on to the parser.
+    //
+    // Both passes parse into a transient document with one node per input
+    // character — every node consumes at least one — and an arena half again
+    // as long, since YAML's \L and \P decode two bytes to three. Pass 1
+    // records what was used; pass 2 copies the nodes, interned strings and
+    // mapping indexes into tables of exactly that size.
+    // Decoded strings are detached into `arena`, a separate static, so `value`
+    // holds no self-references and can be copied into any constexpr variable.
+    template <fixed_string Src, typename Format, data::options Opts = {}>
+    struct exact_document
+    {
+        static constexpr std::size_t length = Src.size();
+        static constexpr std::size_t char_bound = length + length / 2;
+        static constexpr bool sorted = Opts.sorted_keys;
+
+        using upper_bound = basic_document<length, char_bound, length * 2 + 1, sorted ? 0 : length * 3, sorted>;
+
+        struct extent
+        {
+            bool ok{false};
+            data::parse_error error{};
+            std::size_t nodes{0};
+            std::size_t chars{0};
+            std::size_t strings{0};
+            std::size_t index{0};
+            std::array<char, char_bound> arena{};
+        };
+
+        static constexpr extent measured = []
+        {
+            extent e{};
+            if constexpr (length == 0)
+            {
+                e.error = data::parse_error{error_code::invalid_syntax, 0, 0};
+            }
+            else
+            {
+                auto r = Format::template parse<upper_bound, Opts>(Src.view());
+                if (std::holds_alternative<data::parse_error>(r))
+                {
+                    e.error = std::get<data::parse_error>(r);
+                    return e;
+                }
+                auto const &doc = std::get<upper_bound>(r);
+                e.ok = true;
+                e.nodes = doc.pool_size_;
+                e.chars = doc.chars_size_;
+                e.strings = doc.strings_.size_;
+                e.index = doc.index_size_;
+                for (std::size_t i = 0; i < e.chars; ++i)
+                    e.arena[i] = doc.chars_[i];
+            }
+            return e;
+        }();
+
+        using type = basic_document<measured.nodes, 0, measured.strings, measured.index, sorted>;
+
+        static constexpr std::array<char, measured.chars> arena = []
+        {
+            std::array<char, measured.chars> a{};
+            for (std::size_t i = 0; i < measured.chars; ++i)
+                a[i] = measured.arena[i];
+            return a;
+        }();
+
+        static constexpr std::variant<type, data::parse_error> value = []
+            -> std::variant<type, data::parse_error>
+        {
+            if constexpr (!measured.ok)
+            {
+                return measured.error;
+            }
+            else
+            {
+                auto r = Format::template parse<upper_bound, Opts>(Src.view());
+                if (std::holds_alternative<data::parse_error>(r))
+                    return std::get<data::parse_error>(r);
+                return std::get<upper_bound>(r).template detach<measured.nodes, measured.strings, measured.index>(arena.data());
+            }
+        }();
+    };
+
+} // namespace data::detail
@@ -0,0 +1,122 @@
+#pragma once
+
+// A whole file mapped read-only, so a document parsed from it views the
+// page cache directly instead of a copy. Where there is no mmap the file is
+// read into a heap buffer instead, behind the same interface.
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DATA_CT_HAS_MMAP 1
+#else
+#define DATA_CT_HAS_MMAP 0
+#endif
+
+namespace data::detail
+{
+
+    class file_mapping
+    {
+    public:
+        file_mapping() noexcept = default;
+
+        file_mapping(file_mapping &&o) noexcept
+            : data_{std::exchange(o.data_, nullptr)}, size_{std::exchange(o.size_, 0)}
+#if !DATA_CT_HAS_MMAP
+              , buffer_{std::move(o.buffer_)}
+#endif
+        {
+        }
+
+        auto operator=(file_mapping &&o) noexcept -> file_mapping &
+        {
+            if (this != &o)
+            {
+                release();
+                data_ = std::exchange(o.data_, nullptr);
+                size_ = std::exchange(o.size_, 0);
+#if !DATA_CT_HAS_MMAP
+                buffer_ = std::move(o.buffer_);
+#endif
+            }
+            return *this;
+        }
+
+        ~file_mapping() { release(); }
+
+        // false if the file cannot be opened, sized or mapped; an empty file
+        // maps to an empty view
+        [[nodiscard]] auto open(char const *path) noexcept -> bool
+        {
+            release();
+#if DATA_CT_HAS_MMAP
+            auto const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return false;
+            struct stat st{};
+            bool ok = ::fstat(fd, &st) == 0;
+            if (ok && st.st_size > 0)
+            {
+                auto *p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                ok = p != MAP_FAILED;
+                if (ok)
+                {
+                    data_ = static_cast<char const *>(p);
+                    size_ = static_cast<std::size_t>(st.st_size);
+                }
+            }
+            ::close(fd); // the mapping keeps its own reference to the file
+            return ok;
+#else
+            auto *f = std::fopen(path, "rb");
+            if (!f)
+                return false;
+            bool ok = std::fseek(f, 0, SEEK_END) == 0;
+            auto const size = ok ? std::ftell(f) : -1L;
+            ok = size >= 0 && std::fseek(f, 0, SEEK_SET) == 0;
+            if (ok && size > 0)
+            {
+                buffer_.reset(new (std::nothrow) char[static_cast<std::size_t>(size)]);
+                ok = buffer_ && std::fread(buffer_.get(), 1, static_cast<std::size_t>(size), f) == static_cast<std::size_t>(size);
+                if (ok)
+                {
+                    data_ = buffer_.get();
+                    size_ = static_cast<std::size_t>(size);
+                }
+            }
+            std::fclose(f);
+            return ok;
+#endif
+        }
+
+        [[nodiscard]] auto view() const noexcept -> std::string_view { return {data_, size_}; }
+
+    private:
+        char const *data_{nullptr};
+        std::size_t size_{0};
+#if !DATA_CT_HAS_MMAP
+        std::unique_ptr<char[]> buffer_;
+#endif
+
+        auto release() noexcept -> void
+        {
+#if DATA_CT_HAS_MMAP
+            if (data_)
+                ::munmap(const_cast<char *>(data_), size_);
+#else
+            buffer_.reset();
+#endif
+            data_ = nullptr;
+            size_ = 0;
+        }
+    };
+
+} // namespace data::detail
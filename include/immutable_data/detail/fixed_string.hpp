@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace data::detail
+{
+
+    // string literal usable as a template argument
+    template <std::size_t N>
+    struct fixed_string
+    {
+        char data_[N]{};
+
+        constexpr fixed_string(const char (&str)[N]) noexcept
+        {
+            for (std::size_t i = 0; i < N; ++i)
+                data_[i] = str[i];
+        }
+
+        [[nodiscard]] static constexpr auto size() noexcept -> std::size_t { return N - 1; }
+        [[nodiscard]] constexpr auto view() const noexcept -> std::string_view { return {data_, N - 1}; }
+    };
+
+} // namespace data::detail
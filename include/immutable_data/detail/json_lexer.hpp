@@ -1,9 +1,9 @@
 #pragma once
 
-// Compile-time JSON lexer — tokenizes JSON input into a fixed-size token array
+// Compile-time JSON lexer — produces tokens on demand for the parser
 
+#include <immutable_data/detail/simd.hpp>
 #include <immutable_data/detail/types.hpp>
-#include <array>
 #include <string_view>
 #include <variant>
 
@@ -12,43 +12,32 @@ namespace data::json::detail
 
     using namespace data::detail;
 
-    template <std::size_t MaxTokens = 1024>
     class lexer
     {
     public:
         struct state
         {
             std::size_t position{0};
-            std::size_t line{1};
-            std::size_t column{1};
         };
 
-        constexpr lexer() noexcept = default;
+        constexpr explicit lexer(std::string_view input) noexcept : input_{input} {}
 
-        constexpr auto tokenize(std::string_view input) noexcept -> std::variant<token_array<MaxTokens>, data::parse_error>
-        {
-            token_array<MaxTokens> tokens{};
-            std::size_t token_count = 0;
-            state s{};
-
-            while (!at_end(input, s) && token_count < MaxTokens)
-            {
-                skip_whitespace(input, s);
+        [[nodiscard]] constexpr auto input() const noexcept -> std::string_view { return input_; }
 
-                if (at_end(input, s))
-                    break;
-
-                auto token_result = next_token(input, s);
-                if (std::holds_alternative<data::parse_error>(token_result))
-                    return std::get<data::parse_error>(token_result);
-
-                tokens[token_count++] = std::get<token>(token_result);
-            }
-
-            if (token_count < MaxTokens)
-                tokens[token_count] = token{token_type::eof, {}, s.line, s.column};
-
-            return tokens;
+        // the next token, or eof once the input is consumed — the parser pulls
+        // tokens one at a time, so nothing is buffered
+        constexpr auto next() noexcept -> std::variant<token, data::parse_error>
+        {
+            skip_whitespace(input_, s_);
+            if (at_end(input_, s_))
+                return token{token_type::eof, s_.position, 0};
+            auto const start = s_.position;
+            auto r = next_token(input_, s_);
+            // a token records a 32-bit offset and a 24-bit length
+            if (std::holds_alternative<token>(r) &&
+                (s_.position > token::max_offset || s_.position - start > token::max_length))
+                return error_at(input_, start, data::error_code::string_overflow);
+            return r;
         }
 
     private:
@@ -66,25 +55,20 @@ namespace data::json::detail
         {
             if (at_end(input, s))
                 return '\0';
-            char c = input[s.position++];
-            if (c == '\n')
-            {
-                ++s.line;
-                s.column = 1;
-            }
-            else
-            {
-                ++s.column;
-            }
-            return c;
+            return input[s.position++];
         }
 
         static constexpr auto skip_whitespace(std::string_view input, state &s) noexcept -> void
         {
+            if !consteval
+            {
+                s.position = skip_json_space(input, s.position);
+                return;
+            }
             while (!at_end(input, s))
             {
                 char c = peek(input, s);
-                if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+                if (is_class(c, char_class::whitespace))
                     advance(input, s);
                 else
                     break;
@@ -94,29 +78,28 @@ namespace data::json::detail
         static constexpr auto next_token(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
             char c = peek(input, s);
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
+            std::size_t start_pos = s.position;
 
             switch (c)
             {
             case '{':
                 advance(input, s);
-                return token{token_type::mapping_start, "{", start_line, start_column};
+                return token{token_type::mapping_start, start_pos, 1};
             case '}':
                 advance(input, s);
-                return token{token_type::mapping_end, "}", start_line, start_column};
+                return token{token_type::mapping_end, start_pos, 1};
             case '[':
                 advance(input, s);
-                return token{token_type::sequence_start, "[", start_line, start_column};
+                return token{token_type::sequence_start, start_pos, 1};
             case ']':
                 advance(input, s);
-                return token{token_type::sequence_end, "]", start_line, start_column};
+                return token{token_type::sequence_end, start_pos, 1};
             case ':':
                 advance(input, s);
-                return token{token_type::mapping_key, ":", start_line, start_column};
+                return token{token_type::mapping_key, start_pos, 1};
             case ',':
                 advance(input, s);
-                return token{token_type::comma, ",", start_line, start_column};
+                return token{token_type::comma, start_pos, 1};
             case '"':
                 return parse_string(input, s);
             case 't':
@@ -130,13 +113,11 @@ namespace data::json::detail
                 break;
             }
 
-            return data::parse_error{data::error_code::unexpected_token, s.line, s.column};
+            return error_at(input, s.position, data::error_code::unexpected_token);
         }
 
         static constexpr auto parse_string(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             advance(input, s); // skip opening "
@@ -146,27 +127,29 @@ namespace data::json::detail
                 {
                     advance(input, s);
                     if (at_end(input, s))
-                        return data::parse_error{data::error_code::unterminated_string, start_line, start_column};
+                        return error_at(input, start_pos, data::error_code::unterminated_string);
                     advance(input, s); // skip escaped char
                 }
-                else
+                else if consteval
                 {
                     advance(input, s);
                 }
+                else
+                {
+                    // the whole run up to the next quote or backslash at once
+                    s.position = find_quote_or_backslash(input, s.position + 1);
+                }
             }
 
             if (at_end(input, s))
-                return data::parse_error{data::error_code::unterminated_string, start_line, start_column};
+                return error_at(input, start_pos, data::error_code::unterminated_string);
 
             advance(input, s); // skip closing "
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
-            return token{token_type::quoted_string, value, start_line, start_column};
+            return token{token_type::quoted_string, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_number(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             if (peek(input, s) == '-')
@@ -193,15 +176,12 @@ namespace data::json::detail
                     advance(input, s);
             }
 
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
             token_type type = is_float ? token_type::float_literal : token_type::integer_literal;
-            return token{type, value, start_line, start_column};
+            return token{type, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_bool(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             if (peek(input, s) == 't')
@@ -211,7 +191,7 @@ namespace data::json::detail
                     advance(input, s);
                 std::string_view value = input.substr(start_pos, s.position - start_pos);
                 if (value == "true")
-                    return token{token_type::boolean_literal, value, start_line, start_column};
+                    return token{token_type::boolean_literal, start_pos, s.position - start_pos};
             }
             else
             {
@@ -220,16 +200,14 @@ namespace data::json::detail
                     advance(input, s);
                 std::string_view value = input.substr(start_pos, s.position - start_pos);
                 if (value == "false")
-                    return token{token_type::boolean_literal, value, start_line, start_column};
+                    return token{token_type::boolean_literal, start_pos, s.position - start_pos};
             }
 
-            return data::parse_error{data::error_code::unexpected_token, start_line, start_column};
+            return error_at(input, start_pos, data::error_code::unexpected_token);
         }
 
         static constexpr auto parse_null(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             for (int i = 0; i < 4 && !at_end(input, s); ++i)
@@ -237,10 +215,13 @@ namespace data::json::detail
 
             std::string_view value = input.substr(start_pos, s.position - start_pos);
             if (value == "null")
-                return token{token_type::null_literal, value, start_line, start_column};
+                return token{token_type::null_literal, start_pos, s.position - start_pos};
 
-            return data::parse_error{data::error_code::unexpected_token, start_line, start_column};
+            return error_at(input, start_pos, data::error_code::unexpected_token);
         }
+
+        std::string_view input_;
+        state s_{};
     };
 
 } // namespace data::json::detail
@@ -0,0 +1,568 @@
+#pragma once
+
+// Resumable JSON parser for input that arrives in chunks — from a pipe or a
+// socket — so parsing keeps pace with the transfer instead of starting once
+// the whole payload is buffered. An explicit stack of open containers stands
+// in for the recursion of parser, and a token cut off by the end of a chunk
+// is kept until a later chunk completes it. Chunks are not kept, so every
+// string is copied into the document's arena.
+
+#include <immutable_data/detail/escape.hpp>
+#include <immutable_data/detail/json_lexer.hpp>
+#include <immutable_data/detail/number.hpp>
+#include <immutable_data/detail/pmr_document.hpp>
+#include <immutable_data/detail/simd.hpp>
+#include <immutable_data/detail/types.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace data::json::detail
+{
+
+    using namespace data::detail;
+
+    //   stream_parser p{&resource};
+    //   while (p.feed(read_some()) == data::stream_status::need_more) {}
+    //
+    // The document grows from `resource` like parse(text, resource); it is
+    // complete once feed() or finish() returns done. A number at the root
+    // has no closing byte, so it is only complete at the next byte or at
+    // finish(). Errors carry the same codes as parse(), and for malformed
+    // text the same positions.
+    template <data::options Opts = {}>
+    class stream_parser
+    {
+    public:
+        using document_type = options_pmr_document<Opts>;
+
+        explicit stream_parser(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept
+            : doc_{resource}, pending_{resource}
+        {
+        }
+
+        // parse the next chunk; need_more until the root value is complete
+        auto feed(std::span<char const> chunk) noexcept -> stream_status
+        {
+            consumed_ = 0;
+            if (status_ != stream_status::need_more)
+                return status_;
+            chunk_ = {chunk.data(), chunk.size()};
+            std::size_t pos = 0;
+            while (status_ == stream_status::need_more && pos < chunk_.size())
+            {
+                if (token_ != token_kind::none)
+                {
+                    pos = resume_token(pos);
+                    continue;
+                }
+                pos = skip_json_space(chunk_, pos);
+                if (pos < chunk_.size())
+                    pos = step(pos);
+            }
+            end_chunk(pos);
+            return status_;
+        }
+
+        // the input has ended: completes a number at the root, and reports
+        // a document that is still open as an error
+        auto finish() noexcept -> stream_status
+        {
+            if (status_ != stream_status::need_more)
+                return status_;
+            if (offset_ == 0)
+                fail({data::error_code::invalid_syntax, 0, 0});
+            else if (token_ == token_kind::number)
+                end_number({pending_.data(), pending_.size()}, offset_);
+            if (status_ != stream_status::need_more)
+                return status_;
+            if (token_ == token_kind::string)
+                fail(token_error(data::error_code::unterminated_string));
+            else if (token_ == token_kind::literal)
+                fail(token_error(data::error_code::unexpected_token));
+            else if (deferred_ != data::error_code::none)
+                fail(deferred_, offset_);
+            else
+                fail(data::error_code::unexpected_token, offset_);
+            return status_;
+        }
+
+        [[nodiscard]] auto status() const noexcept -> stream_status { return status_; }
+        [[nodiscard]] auto error() const noexcept -> data::parse_error { return error_; }
+
+        // bytes of the last chunk that belong to the document; the rest, if
+        // it is done, is left for whatever follows it in the stream
+        [[nodiscard]] auto consumed() const noexcept -> std::size_t { return consumed_; }
+
+        // the parsed document — complete once status() is done
+        [[nodiscard]] auto document() const noexcept -> document_type const & { return doc_; }
+
+    private:
+        // what the next significant byte may be
+        enum class expect : std::uint8_t
+        {
+            value,      // at the root or after ':'
+            first_item, // after '[': a value or ']'
+            item,       // after ',' in an array
+            first_key,  // after '{': a key or '}'
+            key,        // after ',' in an object
+            colon,
+            comma,      // after a value in a container: ',' or its closing bracket
+        };
+
+        // a token that may continue into the next chunk
+        enum class token_kind : std::uint8_t
+        {
+            none,
+            string,
+            number,
+            literal,
+        };
+
+        struct frame
+        {
+            std::size_t mark_{0};
+            string_ref key_{};
+            bool mapping_{false};
+        };
+
+        document_type doc_;
+        std::pmr::vector<char> pending_; // the part of a token seen in earlier chunks
+        std::array<frame, MAX_PARSE_DEPTH> frames_{};
+        std::size_t depth_{0};
+        expect expect_{expect::value};
+        token_kind token_{token_kind::none};
+        bool escaped_{false};   // the last chunk ended inside a string on a backslash
+        data::error_code deferred_{}; // reported at the next token, as parse() does
+        std::string_view literal_{};
+        std::size_t matched_{0};
+        std::size_t token_start_{0};
+        std::size_t token_line_{0};
+        std::size_t token_column_{0};
+        std::string_view chunk_{};
+        std::size_t offset_{0}; // bytes read before chunk_
+        std::size_t line_{1};
+        std::size_t line_start_{0};
+        std::size_t consumed_{0};
+        stream_status status_{stream_status::need_more};
+        data::parse_error error_{};
+
+        auto top() noexcept -> frame & { return frames_[depth_ - 1]; }
+
+        // positions are offsets from the start of the stream; those in the
+        // current chunk are worked out from it, like error_at()
+        auto error_at_offset(data::error_code ec, std::size_t at) const noexcept -> data::parse_error
+        {
+            auto const seen = chunk_.substr(0, at - offset_);
+            auto const nl = seen.rfind('\n');
+            auto const line = line_ + static_cast<std::size_t>(std::ranges::count(seen, '\n'));
+            return {ec, line, nl == std::string_view::npos ? at - line_start_ + 1 : seen.size() - nl};
+        }
+
+        // errors in a token are reported at its first byte, which an
+        // earlier chunk may have held
+        auto token_error(data::error_code ec) const noexcept -> data::parse_error
+        {
+            if (token_start_ >= offset_)
+                return error_at_offset(ec, token_start_);
+            return {ec, token_line_, token_column_};
+        }
+
+        // an error `k` bytes into the token; `before` holds the token's bytes
+        // up to it, less any opening quote
+        auto error_in_token(data::error_code ec, std::size_t k, std::string_view before) const noexcept
+            -> data::parse_error
+        {
+            if (token_start_ + k >= offset_)
+                return error_at_offset(ec, token_start_ + k);
+            // in an earlier chunk: count on from the token's start
+            auto const nl = before.rfind('\n');
+            return {ec, token_line_ + static_cast<std::size_t>(std::ranges::count(before, '\n')),
+                    nl == std::string_view::npos ? token_column_ + k : before.size() - nl};
+        }
+
+        auto fail(data::parse_error e) noexcept -> std::size_t
+        {
+            error_ = e;
+            status_ = stream_status::error;
+            return chunk_.size();
+        }
+
+        auto fail(data::error_code ec, std::size_t at) noexcept -> std::size_t
+        {
+            return fail(error_at_offset(ec, at));
+        }
+
+        // carry line numbers past the bytes read; a token left open keeps
+        // the position of its start
+        auto end_chunk(std::size_t pos) noexcept -> void
+        {
+            if (token_ != token_kind::none && token_start_ >= offset_)
+            {
+                auto const e = error_at_offset(data::error_code::none, token_start_);
+                token_line_ = e.line;
+                token_column_ = e.column;
+            }
+            auto const read = chunk_.substr(0, pos);
+            line_ += static_cast<std::size_t>(std::ranges::count(read, '\n'));
+            if (auto const nl = read.rfind('\n'); nl != std::string_view::npos)
+                line_start_ = offset_ + nl + 1;
+            offset_ += pos;
+            consumed_ = pos;
+            chunk_ = {};
+        }
+
+        auto keep(std::string_view part) noexcept -> bool
+        {
+            try
+            {
+                pending_.insert(pending_.end(), part.begin(), part.end());
+                return true;
+            }
+            catch (std::bad_alloc const &)
+            {
+                return false;
+            }
+        }
+
+        auto resume_token(std::size_t pos) noexcept -> std::size_t
+        {
+            switch (token_)
+            {
+            case token_kind::string:
+                return resume_string(pos);
+            case token_kind::number:
+                return resume_number(pos);
+            default:
+                return resume_literal(pos);
+            }
+        }
+
+        // one structural byte, or the first byte of a token
+        auto step(std::size_t pos) noexcept -> std::size_t
+        {
+            if (deferred_ != data::error_code::none)
+                return misplaced(pos, deferred_);
+            auto const c = chunk_[pos];
+            switch (expect_)
+            {
+            case expect::value:
+                return begin_value(pos);
+            case expect::first_item:
+                if (c == ']')
+                    return close(pos);
+                return begin_value(pos);
+            case expect::item:
+                if (c == ']')
+                    return fail(data::error_code::trailing_comma, offset_ + pos);
+                return begin_value(pos);
+            case expect::first_key:
+            case expect::key:
+                if (c == '}')
+                {
+                    if (expect_ == expect::key)
+                        return fail(data::error_code::trailing_comma, offset_ + pos);
+                    return close(pos);
+                }
+                if (c != '"')
+                    return fail(data::error_code::unexpected_token, offset_ + pos);
+                return begin_string(pos);
+            case expect::colon:
+                if (c != ':')
+                    return misplaced(pos, data::error_code::unexpected_token);
+                expect_ = expect::value;
+                return pos + 1;
+            case expect::comma:
+                if (c == ',')
+                {
+                    expect_ = top().mapping_ ? expect::key : expect::item;
+                    return pos + 1;
+                }
+                if (c == (top().mapping_ ? '}' : ']'))
+                    return close(pos);
+                return misplaced(pos, data::error_code::unexpected_token);
+            }
+            return pos;
+        }
+
+        // parse() lexes a token before it finds the token out of place, and
+        // a lexer error wins: a string or literal here is read to its end
+        // first, and one that does not lex reports that instead
+        auto misplaced(std::size_t pos, data::error_code ec) noexcept -> std::size_t
+        {
+            auto const c = chunk_[pos];
+            switch (c)
+            {
+            case '"':
+                deferred_ = ec;
+                return begin_string(pos);
+            case 't':
+                deferred_ = ec;
+                return begin_literal(pos, "true");
+            case 'f':
+                deferred_ = ec;
+                return begin_literal(pos, "false");
+            case 'n':
+                deferred_ = ec;
+                return begin_literal(pos, "null");
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',':
+                return fail(ec, offset_ + pos);
+            default:
+                // a number always lexes; anything else does not
+                if (c == '-' || is_digit(c))
+                    return fail(ec, offset_ + pos);
+                return fail(data::error_code::unexpected_token, offset_ + pos);
+            }
+        }
+
+        auto begin_value(std::size_t pos) noexcept -> std::size_t
+        {
+            if (depth_ >= MAX_PARSE_DEPTH)
+                return fail(data::error_code::max_depth_exceeded, offset_ + pos);
+            auto const c = chunk_[pos];
+            switch (c)
+            {
+            case '[':
+            case '{':
+                frames_[depth_++] = frame{doc_.mark(), {}, c == '{'};
+                expect_ = c == '{' ? expect::first_key : expect::first_item;
+                return pos + 1;
+            case '"':
+                return begin_string(pos);
+            case 't':
+                return begin_literal(pos, "true");
+            case 'f':
+                return begin_literal(pos, "false");
+            case 'n':
+                return begin_literal(pos, "null");
+            default:
+                if (c != '-' && !is_digit(c))
+                    return fail(data::error_code::unexpected_token, offset_ + pos);
+                begin_token(token_kind::number, pos);
+                return resume_number(pos);
+            }
+        }
+
+        auto begin_token(token_kind kind, std::size_t pos) noexcept -> void
+        {
+            token_ = kind;
+            token_start_ = offset_ + pos;
+            pending_.clear();
+        }
+
+        // a value is complete: the root, or the next child of the open container
+        auto complete(value const &v, std::size_t at) noexcept -> void
+        {
+            if (depth_ == 0)
+            {
+                doc_.set_root(v);
+                status_ = stream_status::done;
+                return;
+            }
+            auto &f = top();
+            if (!(f.mapping_ ? doc_.stage(f.key_, v) : doc_.stage(v)))
+            {
+                fail(data::error_code::pool_overflow, at);
+                return;
+            }
+            expect_ = expect::comma;
+        }
+
+        auto close(std::size_t pos) noexcept -> std::size_t
+        {
+            auto const f = frames_[--depth_];
+            auto v = value::make_null();
+            if (f.mapping_)
+            {
+                auto const mapping = doc_.finish_mapping(f.mark_);
+                if (!mapping)
+                {
+                    deferred_ = data::error_code::duplicate_key;
+                    return pos + 1;
+                }
+                v = *mapping;
+            }
+            else
+            {
+                v = doc_.finish_sequence(f.mark_);
+            }
+            complete(v, offset_ + pos + 1);
+            return pos + 1;
+        }
+
+        auto begin_string(std::size_t pos) noexcept -> std::size_t
+        {
+            begin_token(token_kind::string, pos);
+            escaped_ = false;
+            return resume_string(pos + 1);
+        }
+
+        // up to the closing quote, or the end of the chunk
+        auto resume_string(std::size_t from) noexcept -> std::size_t
+        {
+            auto i = from;
+            if (escaped_)
+            {
+                escaped_ = false;
+                ++i;
+            }
+            while (true)
+            {
+                i = find_quote_or_backslash(chunk_, i);
+                if (i < chunk_.size() && chunk_[i] == '\\' && i + 1 < chunk_.size())
+                {
+                    i += 2;
+                    continue;
+                }
+                if (i < chunk_.size() && chunk_[i] == '"')
+                {
+                    if (deferred_ != data::error_code::none)
+                        return fail(token_error(deferred_));
+                    break;
+                }
+                escaped_ = i < chunk_.size();
+                if (!keep(chunk_.substr(from)))
+                    return fail(token_error(data::error_code::string_overflow));
+                return chunk_.size();
+            }
+
+            auto raw = chunk_.substr(from, i - from);
+            if (!pending_.empty())
+            {
+                if (!keep(raw))
+                    return fail(token_error(data::error_code::string_overflow));
+                raw = {pending_.data(), pending_.size()};
+            }
+            token_ = token_kind::none;
+
+            if (!doc_.can_store(raw.size()))
+                return fail(token_error(data::error_code::string_overflow));
+            auto const start = doc_.chars_size_;
+            if (auto const bad = decode_escapes<escape_dialect::json>(raw, find_escape(raw), doc_); bad != std::string_view::npos)
+            {
+                return fail(error_in_token(data::error_code::invalid_escape_sequence, 1 + bad, raw.substr(0, bad)));
+            }
+            auto const s = doc_.commit(start);
+
+            if (expect_ == expect::first_key || expect_ == expect::key)
+            {
+                auto &f = top();
+                if (doc_.is_staged(f.mark_, s.view()))
+                    deferred_ = data::error_code::duplicate_key;
+                f.key_ = s;
+                expect_ = expect::colon;
+            }
+            else
+            {
+                complete(value::make_string(s), offset_ + i + 1);
+            }
+            return i + 1;
+        }
+
+        static constexpr auto is_number_char(char c) noexcept -> bool
+        {
+            return is_digit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+        }
+
+        // a number only ends at the first byte that cannot continue it
+        auto resume_number(std::size_t from) noexcept -> std::size_t
+        {
+            auto end = from;
+            while (end < chunk_.size() && is_number_char(chunk_[end]))
+                ++end;
+            auto text = chunk_.substr(from, end - from);
+            if (end == chunk_.size() || !pending_.empty())
+            {
+                if (!keep(text))
+                    return fail(token_error(data::error_code::string_overflow));
+                if (end == chunk_.size())
+                    return end;
+                text = {pending_.data(), pending_.size()};
+            }
+            end_number(text, offset_ + end);
+            return end;
+        }
+
+        // the bytes gathered may be more than one of parse()'s tokens —
+        // "1.5e3." is 1.5e3 and then '.' — so the number is the first of
+        // them, and in a container what follows it is out of place
+        auto end_number(std::string_view text, std::size_t at) noexcept -> void
+        {
+            token_ = token_kind::none;
+            auto const tok = std::get<token>(lexer{text}.next());
+            auto const number = text.substr(0, tok.length_);
+            auto v = value::make_null();
+            if (tok.type_ == token_type::float_literal)
+            {
+                auto const f = data::detail::parse_float(number);
+                if (!f)
+                {
+                    fail(token_error(data::error_code::invalid_syntax));
+                    return;
+                }
+                v = value::make_float(*f);
+            }
+            else
+            {
+                auto const n = data::detail::parse_integer(number);
+                if (n.status == integer_status::invalid)
+                {
+                    fail(token_error(data::error_code::invalid_syntax));
+                    return;
+                }
+                auto const f = n.status == integer_status::overflow && Opts.overflow_to_float
+                                   ? data::detail::parse_float(number)
+                                   : std::nullopt;
+                if (n.status == integer_status::overflow && !f)
+                {
+                    fail(token_error(data::error_code::integer_overflow));
+                    return;
+                }
+                v = f ? value::make_float(*f) : value::make_int(n.value);
+            }
+            if (number.size() < text.size() && depth_ > 0)
+            {
+                fail(error_in_token(data::error_code::unexpected_token, number.size(), number));
+                return;
+            }
+            complete(v, at);
+        }
+
+        auto begin_literal(std::size_t pos, std::string_view word) noexcept -> std::size_t
+        {
+            begin_token(token_kind::literal, pos);
+            literal_ = word;
+            matched_ = 0;
+            return resume_literal(pos);
+        }
+
+        // true, false and null are matched byte by byte as they arrive
+        auto resume_literal(std::size_t from) noexcept -> std::size_t
+        {
+            auto i = from;
+            for (; i < chunk_.size() && matched_ < literal_.size(); ++i, ++matched_)
+                if (chunk_[i] != literal_[matched_])
+                    return fail(token_error(data::error_code::unexpected_token));
+            if (matched_ < literal_.size())
+                return i;
+            if (deferred_ != data::error_code::none)
+                return fail(token_error(deferred_));
+            token_ = token_kind::none;
+            complete(literal_[0] == 'n' ? value::make_null() : value::make_bool(literal_[0] == 't'), offset_ + i);
+            return i;
+        }
+    };
+
+} // namespace data::json::detail
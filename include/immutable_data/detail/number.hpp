@@ -0,0 +1,624 @@
+#pragma once
+
+// Shared number conversion for all four formats, the same at compile time and
+// at runtime: parse_integer checks int64 range and reads 0x/0o/0b literals;
+// parse_float rounds decimal to binary64 correctly.
+//
+// parse_float takes the text a lexer classified as a float: an optional sign,
+// digits with an optional '.', an optional exponent, and '_' separators
+// (TOML), or inf/nan. Three steps, each exact where it answers:
+//   1. Clinger's fast path — a mantissa below 2^53 and a power of ten below
+//      10^23 are both exact doubles, so one IEEE multiply or divide rounds
+//      correctly.
+//   2. Eisel-Lemire — multiply the 19-digit mantissa by a 128-bit truncated
+//      power of five and keep the result unless it sits too close to a
+//      halfway point to decide.
+//   3. Simple decimal conversion — shift a big decimal by powers of two until
+//      it is in range. Slow but exact; only ambiguous inputs reach it.
+
+#include <immutable_data/detail/power_of_five.hpp>
+#include <immutable_data/detail/utils.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+namespace data::detail
+{
+
+    namespace float_bits
+    {
+        inline constexpr int mantissa_bits = 52;
+        inline constexpr int minimum_exponent = -1023;
+        inline constexpr int infinite_power = 0x7FF;
+        inline constexpr std::uint64_t hidden_bit = std::uint64_t{1} << mantissa_bits;
+
+        // significand without the hidden bit, and the biased exponent; a
+        // negative power2 means the approximation could not decide
+        struct adjusted
+        {
+            std::uint64_t mantissa{0};
+            std::int32_t power2{0};
+
+            constexpr bool operator==(adjusted const &) const noexcept = default;
+        };
+
+        inline constexpr adjusted infinity{0, infinite_power};
+        inline constexpr adjusted undecided{0, -1};
+
+        constexpr auto to_double(adjusted a, bool negative) noexcept -> double
+        {
+            auto bits = a.mantissa | (static_cast<std::uint64_t>(a.power2) << mantissa_bits);
+            if (negative)
+                bits |= std::uint64_t{1} << 63;
+            return std::bit_cast<double>(bits);
+        }
+    } // namespace float_bits
+
+    struct uint128
+    {
+        std::uint64_t low{0};
+        std::uint64_t high{0};
+    };
+
+    constexpr auto full_multiplication(std::uint64_t a, std::uint64_t b) noexcept -> uint128
+    {
+        auto const a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+        auto const b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+        auto const lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+        auto const lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+        auto const cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFu) + lo_hi;
+        return {(cross << 32) | (lo_lo & 0xFFFFFFFFu), (hi_lo >> 32) + (cross >> 32) + hi_hi};
+    }
+
+    // Eisel-Lemire: w * 10^q for a nonzero w
+    constexpr auto eisel_lemire(std::int64_t q, std::uint64_t w) noexcept -> float_bits::adjusted
+    {
+        using namespace float_bits;
+        if (w == 0 || q < smallest_power_of_five)
+            return {};
+        if (q > largest_power_of_five)
+            return infinity;
+
+        auto const lz = std::countl_zero(w);
+        w <<= lz;
+
+        // w * 5^q to 55 significant bits; the second word is only needed when
+        // the bits below them are all ones
+        auto const index = static_cast<std::size_t>(2 * (q - smallest_power_of_five));
+        auto product = full_multiplication(w, power_of_five_128[index]);
+        constexpr std::uint64_t precision_mask = ~std::uint64_t{0} >> (mantissa_bits + 3);
+        if ((product.high & precision_mask) == precision_mask)
+        {
+            auto const second = full_multiplication(w, power_of_five_128[index + 1]);
+            product.low += second.high;
+            if (second.high > product.low)
+                ++product.high;
+        }
+        // the truncated product may be off by one ulp of the low word
+        if (product.low == ~std::uint64_t{0} && (q < -27 || q > 55))
+            return undecided;
+
+        auto const upper_bit = static_cast<int>(product.high >> 63);
+        auto const shift = upper_bit + 64 - mantissa_bits - 3;
+        adjusted a{product.high >> shift, 0};
+        // floor(q * log2(10)) + 63, exact over the table's range
+        auto const power = static_cast<std::int32_t>((((152170 + 65536) * q) >> 16) + 63);
+        a.power2 = power + upper_bit - lz - minimum_exponent;
+
+        if (a.power2 <= 0) // subnormal
+        {
+            if (-a.power2 + 1 >= 64)
+                return {};
+            a.mantissa >>= -a.power2 + 1;
+            a.mantissa += a.mantissa & 1;
+            a.mantissa >>= 1;
+            a.power2 = a.mantissa < hidden_bit ? 0 : 1;
+            return a;
+        }
+
+        // exactly halfway: round to even instead of up
+        if (product.low <= 1 && q >= -4 && q <= 23 && (a.mantissa & 3) == 1 &&
+            (a.mantissa << shift) == product.high)
+            a.mantissa &= ~std::uint64_t{1};
+
+        a.mantissa += a.mantissa & 1;
+        a.mantissa >>= 1;
+        if (a.mantissa >= (hidden_bit << 1))
+        {
+            a.mantissa = hidden_bit;
+            ++a.power2;
+        }
+        a.mantissa &= ~hidden_bit;
+        if (a.power2 >= infinite_power)
+            return infinity;
+        return a;
+    }
+
+    // Arbitrary-precision decimal 0.d1d2d3... * 10^decimal_point, enough
+    // digits to decide any binary64 rounding
+    struct big_decimal
+    {
+        static constexpr std::size_t max_digits = 768;
+        static constexpr std::int32_t decimal_point_range = 2047;
+
+        std::uint32_t num_digits{0};
+        std::int32_t decimal_point{0};
+        bool truncated{false};
+        std::array<std::uint8_t, max_digits> digits{};
+
+        constexpr auto push(std::uint8_t d) noexcept -> void
+        {
+            if (num_digits < max_digits)
+                digits[num_digits++] = d;
+            else if (d != 0)
+                truncated = true;
+        }
+
+        constexpr auto trim() noexcept -> void
+        {
+            while (num_digits > 0 && digits[num_digits - 1] == 0)
+                --num_digits;
+        }
+
+        // *= 2^shift, shift <= 60
+        constexpr auto left_shift(std::uint32_t shift) noexcept -> void
+        {
+            if (num_digits == 0)
+                return;
+            std::array<std::uint8_t, max_digits + 20> reversed{};
+            std::size_t count = 0;
+            std::uint64_t carry = 0;
+            for (auto i = num_digits; i-- > 0;)
+            {
+                auto const n = (std::uint64_t{digits[i]} << shift) + carry;
+                reversed[count++] = static_cast<std::uint8_t>(n % 10);
+                carry = n / 10;
+            }
+            for (; carry != 0; carry /= 10)
+                reversed[count++] = static_cast<std::uint8_t>(carry % 10);
+
+            decimal_point += static_cast<std::int32_t>(count - num_digits);
+            // keep the most significant digits; dropped ones only mark truncation
+            std::size_t const keep = count < max_digits ? count : max_digits;
+            for (std::size_t i = 0; i < count - keep; ++i)
+                if (reversed[i] != 0)
+                    truncated = true;
+            for (std::size_t i = 0; i < keep; ++i)
+                digits[i] = reversed[count - 1 - i];
+            num_digits = static_cast<std::uint32_t>(keep);
+            trim();
+        }
+
+        // /= 2^shift, shift <= 60
+        constexpr auto right_shift(std::uint32_t shift) noexcept -> void
+        {
+            std::size_t read = 0, write = 0;
+            std::uint64_t n = 0;
+            while ((n >> shift) == 0)
+            {
+                if (read < num_digits)
+                {
+                    n = 10 * n + digits[read++];
+                }
+                else if (n == 0)
+                {
+                    return;
+                }
+                else
+                {
+                    while ((n >> shift) == 0)
+                    {
+                        n *= 10;
+                        ++read;
+                    }
+                    break;
+                }
+            }
+            decimal_point -= static_cast<std::int32_t>(read) - 1;
+            if (decimal_point < -decimal_point_range)
+            {
+                num_digits = 0;
+                decimal_point = 0;
+                truncated = false;
+                return;
+            }
+            auto const mask = (std::uint64_t{1} << shift) - 1;
+            while (read < num_digits)
+            {
+                auto const d = static_cast<std::uint8_t>(n >> shift);
+                n = 10 * (n & mask) + digits[read++];
+                digits[write++] = d;
+            }
+            while (n > 0)
+            {
+                auto const d = static_cast<std::uint8_t>(n >> shift);
+                n = 10 * (n & mask);
+                if (write < max_digits)
+                    digits[write++] = d;
+                else if (d > 0)
+                    truncated = true;
+            }
+            num_digits = static_cast<std::uint32_t>(write);
+            trim();
+        }
+
+        // the integer part, rounded half to even
+        [[nodiscard]] constexpr auto round() const noexcept -> std::uint64_t
+        {
+            if (num_digits == 0 || decimal_point < 0)
+                return 0;
+            if (decimal_point > 18)
+                return ~std::uint64_t{0};
+            auto const dp = static_cast<std::uint32_t>(decimal_point);
+            std::uint64_t n = 0;
+            for (std::uint32_t i = 0; i < dp; ++i)
+                n = 10 * n + (i < num_digits ? digits[i] : 0);
+            bool round_up = false;
+            if (dp < num_digits)
+            {
+                round_up = digits[dp] >= 5;
+                if (digits[dp] == 5 && dp + 1 == num_digits)
+                    round_up = truncated || (dp > 0 && (digits[dp - 1] & 1));
+            }
+            return round_up ? n + 1 : n;
+        }
+
+        [[nodiscard]] constexpr auto to_adjusted() noexcept -> float_bits::adjusted
+        {
+            using namespace float_bits;
+            if (num_digits == 0 || decimal_point < -324)
+                return {};
+            if (decimal_point >= 310)
+                return infinity;
+
+            constexpr std::uint32_t max_shift = 60;
+            constexpr std::uint32_t num_powers = 19;
+            constexpr std::uint8_t powers[num_powers] = {0, 3, 6, 9, 13, 16, 19, 23, 26, 29, 33, 36, 39, 43, 46, 49, 53, 56, 59};
+
+            std::int32_t exp2 = 0;
+            while (decimal_point > 0)
+            {
+                auto const n = static_cast<std::uint32_t>(decimal_point);
+                auto const shift = n < num_powers ? powers[n] : max_shift;
+                right_shift(shift);
+                exp2 += static_cast<std::int32_t>(shift);
+            }
+            while (decimal_point <= 0)
+            {
+                std::uint32_t shift;
+                if (decimal_point == 0)
+                {
+                    if (digits[0] >= 5)
+                        break;
+                    shift = digits[0] < 2 ? 2 : 1;
+                }
+                else
+                {
+                    auto const n = static_cast<std::uint32_t>(-decimal_point);
+                    shift = n < num_powers ? powers[n] : max_shift;
+                }
+                left_shift(shift);
+                if (decimal_point > decimal_point_range)
+                    return infinity;
+                exp2 -= static_cast<std::int32_t>(shift);
+            }
+            // now in [1/2, 1): make it [1, 2)
+            --exp2;
+            while (minimum_exponent + 1 > exp2)
+            {
+                auto n = static_cast<std::uint32_t>(minimum_exponent + 1 - exp2);
+                if (n > max_shift)
+                    n = max_shift;
+                right_shift(n);
+                exp2 += static_cast<std::int32_t>(n);
+            }
+            if (exp2 - minimum_exponent >= infinite_power)
+                return infinity;
+
+            left_shift(mantissa_bits + 1);
+            auto mantissa = round();
+            if (mantissa >= (hidden_bit << 1))
+            {
+                right_shift(1);
+                ++exp2;
+                mantissa = round();
+                if (exp2 - minimum_exponent >= infinite_power)
+                    return infinity;
+            }
+            auto power2 = exp2 - minimum_exponent;
+            if (mantissa < hidden_bit)
+                --power2;
+            return {mantissa & ~hidden_bit, power2};
+        }
+    };
+
+    // digits (with '.' and '_') times 10^exponent through big_decimal; kept
+    // out of parse_float so its buffers are not in every call's frame
+    constexpr auto exact_decimal(std::string_view mantissa, std::int64_t exponent) noexcept -> float_bits::adjusted
+    {
+        big_decimal d{};
+        bool integral = true;
+        for (auto const c : mantissa)
+        {
+            if (c == '.')
+                integral = false;
+            if (!is_digit(c))
+                continue;
+            auto const digit = static_cast<std::uint8_t>(c - '0');
+            if (d.num_digits == 0 && digit == 0)
+            {
+                if (!integral)
+                    --d.decimal_point; // leading fraction zeros scale it down
+                continue;
+            }
+            d.push(digit);
+            if (integral)
+                ++d.decimal_point;
+        }
+        d.trim();
+        d.decimal_point += static_cast<std::int32_t>(exponent);
+        return d.to_adjusted();
+    }
+
+    // eight bytes at `pos` as a little-endian word (runtime only)
+    inline auto read_eight(std::string_view text, std::size_t pos) noexcept -> std::uint64_t
+    {
+        std::uint64_t v;
+        std::memcpy(&v, text.data() + pos, sizeof v);
+        if constexpr (std::endian::native == std::endian::big)
+            v = std::byteswap(v);
+        return v;
+    }
+
+    constexpr bool is_eight_digits(std::uint64_t v) noexcept
+    {
+        return (((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+                0x3333333333333333);
+    }
+
+    // eight ASCII digits, first one in the low byte, in three multiplies
+    constexpr auto eight_digits_value(std::uint64_t v) noexcept -> std::uint64_t
+    {
+        constexpr std::uint64_t mask = 0x000000FF000000FF;
+        v -= 0x3030303030303030;
+        v = (v * 10) + (v >> 8);
+        return (((v & mask) * 0x000F424000000064) + (((v >> 16) & mask) * 0x0000271000000001)) >> 32;
+    }
+
+    // a '_' separator at `i` with a digit on both sides
+    constexpr auto is_separator(std::string_view text, std::size_t i, bool (*digit)(char)) noexcept -> bool
+    {
+        return text[i] == '_' && i > 0 && digit(text[i - 1]) && i + 1 < text.size() && digit(text[i + 1]);
+    }
+
+    // decimal digits and '_' separators from `i` on, appended to w (wrapping);
+    // returns how many digits. A '_' without a digit on both sides ends the
+    // scan like any other byte. At runtime whole runs of eight go through SWAR.
+    constexpr auto scan_digits(std::string_view text, std::size_t &i, std::uint64_t &w) noexcept -> std::size_t
+    {
+        std::size_t count = 0;
+        if !consteval
+        {
+            while (i + 8 <= text.size() && is_eight_digits(read_eight(text, i)))
+            {
+                w = 100000000 * w + eight_digits_value(read_eight(text, i));
+                count += 8;
+                i += 8;
+            }
+        }
+        for (; i < text.size(); ++i)
+        {
+            if (is_digit(text[i]))
+            {
+                w = 10 * w + static_cast<std::uint64_t>(text[i] - '0');
+                ++count;
+            }
+            else if (!is_separator(text, i, is_digit))
+            {
+                break;
+            }
+        }
+        return count;
+    }
+
+    // text of a float literal to the nearest double; nullopt when it is not one
+    constexpr auto parse_float(std::string_view text) noexcept -> std::optional<double>
+    {
+        std::size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+            negative = text[i++] == '-';
+
+        // every digit into w, wrapping; recounted below if there are too many
+        std::uint64_t w = 0;
+        auto const first = i;
+        auto digits = scan_digits(text, i, w);
+        auto const fraction = i;
+        std::int64_t fraction_digits = 0;
+        if (i < text.size() && text[i] == '.')
+            fraction_digits = static_cast<std::int64_t>(scan_digits(text, ++i, w));
+        digits += static_cast<std::size_t>(fraction_digits);
+        if (digits == 0)
+        {
+            if (text.substr(first) == "inf")
+                return negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+            if (text.substr(first) == "nan")
+                return std::numeric_limits<double>::quiet_NaN();
+            return std::nullopt;
+        }
+
+        auto const mantissa_end = i;
+        std::int64_t exponent = 0;
+        if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+        {
+            ++i;
+            bool const negative_exponent = i < text.size() && text[i] == '-';
+            if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+                ++i;
+            bool exponent_digit = false;
+            for (; i < text.size() && (is_digit(text[i]) || is_separator(text, i, is_digit)); ++i)
+            {
+                if (text[i] == '_')
+                    continue;
+                exponent_digit = true;
+                if (exponent < 0x10000) // far past any double; stop growing
+                    exponent = 10 * exponent + (text[i] - '0');
+            }
+            if (!exponent_digit)
+                return std::nullopt;
+            if (negative_exponent)
+                exponent = -exponent;
+        }
+        if (i != text.size())
+            return std::nullopt;
+        auto q = exponent - fraction_digits;
+
+        // past 19 digits w has wrapped: keep the first 19 significant ones and
+        // note whether anything nonzero was dropped
+        bool dropped_nonzero = false;
+        if (digits > 19)
+        {
+            w = 0;
+            q = exponent;
+            int taken = 0;
+            for (auto j = first; j < mantissa_end; ++j)
+            {
+                if (!is_digit(text[j]))
+                    continue;
+                auto const d = static_cast<std::uint64_t>(text[j] - '0');
+                bool const integral = j < fraction;
+                if (taken == 19)
+                {
+                    if (integral)
+                        ++q;
+                    dropped_nonzero |= d != 0;
+                    continue;
+                }
+                if (!integral)
+                    --q;
+                if (w != 0 || d != 0)
+                {
+                    w = 10 * w + d;
+                    ++taken;
+                }
+            }
+        }
+
+        if (w == 0)
+            return negative ? -0.0 : 0.0;
+
+        // 1. both operands exact: one correctly rounded operation
+        if (!dropped_nonzero && q >= -22 && q <= 22 && w <= float_bits::hidden_bit << 1)
+        {
+            constexpr double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            auto v = static_cast<double>(w);
+            v = q < 0 ? v / powers_of_ten[-q] : v * powers_of_ten[q];
+            return negative ? -v : v;
+        }
+
+        // 2. with digits dropped the value lies in [w, w + 1) * 10^q: keep the
+        // answer when both ends round the same way
+        auto a = eisel_lemire(q, w);
+        if (dropped_nonzero && a != eisel_lemire(q, w + 1))
+            a = float_bits::undecided;
+        if (a.power2 >= 0)
+            return float_bits::to_double(a, negative);
+
+        // 3. every digit, exactly
+        return float_bits::to_double(exact_decimal(text.substr(first, mantissa_end - first), exponent), negative);
+    }
+
+    enum class integer_status : std::uint8_t
+    {
+        ok,
+        overflow, // well-formed, but outside int64
+        invalid,
+    };
+
+    struct parsed_integer
+    {
+        std::int64_t value{0};
+        integer_status status{integer_status::invalid};
+    };
+
+    // int64 from a sign and a magnitude, or overflow
+    constexpr auto signed_integer(std::uint64_t magnitude, bool negative) noexcept -> parsed_integer
+    {
+        if (magnitude > (std::uint64_t{1} << 63) - (negative ? 0 : 1))
+            return {0, integer_status::overflow};
+        // -2^63 has no positive counterpart: negate in unsigned
+        return {static_cast<std::int64_t>(negative ? ~magnitude + 1 : magnitude), integer_status::ok};
+    }
+
+    // digits of base 2^shift (with '_' separators) after a 0x / 0o / 0b prefix
+    constexpr auto parse_prefixed_integer(std::string_view digits, unsigned shift, bool negative) noexcept -> parsed_integer
+    {
+        std::uint64_t v = 0;
+        bool any = false;
+        for (std::size_t i = 0; i < digits.size(); ++i)
+        {
+            auto const c = digits[i];
+            if (c == '_' && is_separator(digits, i, is_hex))
+                continue;
+            if (!is_hex(c) || hex_value(c) >= (1u << shift))
+                return {};
+            if (v >> (64 - shift) != 0)
+                return {0, integer_status::overflow};
+            v = v << shift | hex_value(c);
+            any = true;
+        }
+        return any ? signed_integer(v, negative) : parsed_integer{};
+    }
+
+    // text of an integer literal: an optional sign, then decimal digits or a
+    // 0x / 0o / 0b prefix and digits of that base, with '_' separators (TOML)
+    constexpr auto parse_integer(std::string_view text) noexcept -> parsed_integer
+    {
+        std::size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+            negative = text[i++] == '-';
+
+        if (i + 1 < text.size() && text[i] == '0' && !is_digit(text[i + 1]))
+        {
+            auto const p = text[i + 1];
+            auto const shift = p == 'x' ? 4u : p == 'o' ? 3u : p == 'b' ? 1u : 0u;
+            if (shift != 0)
+                return parse_prefixed_integer(text.substr(i + 2), shift, negative);
+        }
+
+        auto const first = i;
+        std::uint64_t v = 0;
+        auto const digits = scan_digits(text, i, v);
+        if (digits == 0 || i != text.size())
+            return {};
+        // 19 digits always fit in 64 bits; past that, only if the extra ones
+        // are leading zeros
+        if (digits > 19)
+        {
+            auto const rest = text.substr(first);
+            auto const zeros = std::ranges::count(rest.substr(0, rest.find_first_not_of("0_")), '0');
+            if (digits - static_cast<std::size_t>(zeros) > 19)
+                return {0, integer_status::overflow};
+        }
+        return signed_integer(v, negative);
+    }
+
+    // TOML's stricter integers: no sign on a 0x / 0o / 0b literal and no
+    // leading zero on a decimal one
+    constexpr auto parse_toml_integer(std::string_view text) noexcept -> parsed_integer
+    {
+        auto const sign = !text.empty() && (text[0] == '-' || text[0] == '+');
+        auto const digits = text.substr(sign ? 1 : 0);
+        if (digits.size() > 1 && digits[0] == '0' && (sign || is_digit(digits[1]) || digits[1] == '_'))
+            return {};
+        return parse_integer(text);
+    }
+
+} // namespace data::detail
@@ -0,0 +1,392 @@
+#pragma once
+
+// Runtime document whose node pool, string table, indexes and character
+// arena grow through a caller-supplied std::pmr::memory_resource, for inputs
+// whose size is not known when the program is built. Lookups are the same
+// document_lookup code basic_document uses.
+
+#include <immutable_data/detail/types.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace data::detail
+{
+
+    // string_table with id and slot tables that grow as strings are added;
+    // intern() may throw std::bad_alloc, find() never allocates
+    struct pmr_string_table
+    {
+        static constexpr std::uint32_t npos = ~std::uint32_t{0};
+
+        std::pmr::vector<string_ref> strings_;
+        std::pmr::vector<std::uint32_t> slots_; // id + 1, 0 = free; empty or a power of two
+
+        explicit pmr_string_table(std::pmr::memory_resource *resource) noexcept
+            : strings_{resource}, slots_{resource}
+        {
+        }
+
+        [[nodiscard]] auto operator[](std::uint32_t id) const noexcept -> string_ref const &
+        {
+            return strings_[id];
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t { return strings_.size(); }
+
+        [[nodiscard]] auto find(std::string_view s) const noexcept -> std::uint32_t
+        {
+            return find(s, hash_string(s));
+        }
+
+        [[nodiscard]] auto find(std::string_view s, std::uint32_t hash) const noexcept -> std::uint32_t
+        {
+            if (s.empty())
+                return strings_.empty() ? npos : 0;
+            if (slots_.empty())
+                return npos;
+            auto const mask = slots_.size() - 1;
+            for (auto slot = hash & mask;; slot = (slot + 1) & mask)
+            {
+                if (slots_[slot] == 0)
+                    return npos;
+                if (strings_[slots_[slot] - 1].view() == s)
+                    return slots_[slot] - 1;
+            }
+        }
+
+        auto intern(string_ref s) -> std::uint32_t { return intern(s, hash_string(s.view())); }
+
+        auto intern(string_ref s, std::uint32_t hash) -> std::uint32_t
+        {
+            if (strings_.empty())
+                strings_.emplace_back(); // id 0, the empty string
+            if (s.size_ == 0)
+                return 0;
+            if (auto const id = find(s.view(), hash); id != npos)
+                return id;
+            // at most half full, so probe runs stay short
+            if ((strings_.size() + 1) * 2 > slots_.size())
+                rehash(std::max<std::size_t>(slots_.size() * 2, 64));
+            strings_.push_back(s);
+            auto const id = static_cast<std::uint32_t>(strings_.size() - 1);
+            place(id, hash);
+            return id;
+        }
+
+    private:
+        auto place(std::uint32_t id, std::uint32_t hash) noexcept -> void
+        {
+            auto const mask = slots_.size() - 1;
+            auto slot = hash & mask;
+            while (slots_[slot] != 0)
+                slot = (slot + 1) & mask;
+            slots_[slot] = id + 1;
+        }
+
+        auto rehash(std::size_t count) -> void
+        {
+            std::pmr::vector<std::uint32_t> slots(count, 0, slots_.get_allocator());
+            strings_.reserve(count / 2);
+            slots_.swap(slots);
+            for (std::uint32_t id = 1; id < strings_.size(); ++id)
+                place(id, hash_string(strings_[id].view()));
+        }
+    };
+
+    // document — the same value, key column and lookup layout as
+    // basic_document, in vectors drawn from `resource` instead of fixed
+    // arrays, so neither the pool nor the arena has a capacity to overflow;
+    // pool_overflow and string_overflow now mean the resource is exhausted.
+    // Staged children go on a stack of their own; the pool keeps room for
+    // all of them, so finishing a container never allocates. Arena strings
+    // are written into blocks that are never moved, so values keep pointing
+    // at them as the arena grows. The document can be moved but not copied,
+    // and the resource must outlive it.
+    template <bool SortedKeys = false>
+    class pmr_document : public document_lookup<pmr_document<SortedKeys>>
+    {
+    public:
+        static constexpr bool sorted_keys = SortedKeys;
+
+        value root_{};
+        std::pmr::vector<std::uint32_t> keys_;
+        std::pmr::vector<value> nodes_;
+        std::size_t pool_size_{0};
+        pmr_string_table strings_;
+        std::pmr::vector<std::uint32_t> index_;
+        std::size_t index_size_{0};
+        std::pmr::vector<std::uint32_t> order_;
+        std::size_t chars_size_{0}; // used bytes of the current arena block
+
+        explicit pmr_document(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept
+            : keys_{resource}, nodes_{resource}, strings_{resource}, index_{resource}, order_{resource},
+              staged_keys_{resource}, staged_nodes_{resource}, resource_{resource}
+        {
+        }
+
+        pmr_document(pmr_document &&o) noexcept
+            : document_lookup<pmr_document>{o}, root_{o.root_}, keys_{std::move(o.keys_)}, nodes_{std::move(o.nodes_)},
+              pool_size_{o.pool_size_}, strings_{std::move(o.strings_)}, index_{std::move(o.index_)},
+              index_size_{o.index_size_}, order_{std::move(o.order_)}, chars_size_{o.chars_size_},
+              staged_keys_{std::move(o.staged_keys_)}, staged_nodes_{std::move(o.staged_nodes_)},
+              reserved_{o.reserved_}, resource_{o.resource_}, block_{std::exchange(o.block_, nullptr)}
+        {
+        }
+
+        pmr_document(pmr_document const &) = delete;
+        auto operator=(pmr_document const &) -> pmr_document & = delete;
+        auto operator=(pmr_document &&) -> pmr_document & = delete;
+
+        ~pmr_document()
+        {
+            while (auto *b = block_)
+            {
+                block_ = b->prev_;
+                resource_->deallocate(b, sizeof(block) + b->size_, alignof(block));
+            }
+        }
+
+        [[nodiscard]] auto resource() const noexcept -> std::pmr::memory_resource * { return resource_; }
+
+        auto set_root(value const &v) noexcept -> void { root_ = kept(v); }
+
+        // bytes of arena in use, across every block
+        [[nodiscard]] auto arena_size() const noexcept -> std::size_t
+        {
+            std::size_t total = chars_size_;
+            for (auto const *b = block_ ? block_->prev_ : nullptr; b; b = b->prev_)
+                total += b->used_;
+            return total;
+        }
+
+        [[nodiscard]] auto mark() const noexcept -> std::size_t { return staged_keys_.size(); }
+
+        [[nodiscard]] auto staged(std::size_t mark) const noexcept -> std::size_t
+        {
+            return staged_keys_.size() - mark;
+        }
+
+        // stage one child — false when the resource cannot supply room
+        [[nodiscard]] auto stage(value const &v) noexcept -> bool { return stage_id(0, kept(v)); }
+
+        [[nodiscard]] auto stage(string_ref key, value const &v) noexcept -> bool
+        {
+            try
+            {
+                return stage_id(strings_.intern(kept(key)), kept(v));
+            }
+            catch (std::bad_alloc const &)
+            {
+                return false;
+            }
+        }
+
+        // true if `key` is already staged since `mark` — always false with
+        // SortedKeys, where finish_mapping() finds duplicates by sorting
+        [[nodiscard]] auto is_staged(std::size_t mark, std::string_view key) const noexcept -> bool
+        {
+            if constexpr (SortedKeys)
+                return false;
+            auto const id = strings_.find(key);
+            if (id == strings_.npos)
+                return false;
+            return std::find(staged_keys_.begin() + mark, staged_keys_.end(), id) != staged_keys_.end();
+        }
+
+        // move the children staged since `mark` to the end of the pool and
+        // return where they start
+        auto finish(std::size_t mark) noexcept -> std::size_t
+        {
+            auto const start = pool_size_;
+            keys_.insert(keys_.end(), staged_keys_.begin() + mark, staged_keys_.end());
+            nodes_.insert(nodes_.end(), staged_nodes_.begin() + mark, staged_nodes_.end());
+            staged_keys_.resize(mark);
+            staged_nodes_.resize(mark);
+            pool_size_ = nodes_.size();
+            if constexpr (SortedKeys)
+                order_.resize(pool_size_);
+            return start;
+        }
+
+        // drop the children staged since `mark`, for a stream parser that
+        // parses an entry again once more input is there; what they finished
+        // or copied stays behind, unreferenced
+        auto unstage(std::size_t mark) noexcept -> void
+        {
+            staged_keys_.resize(mark);
+            staged_nodes_.resize(mark);
+        }
+
+        auto finish_sequence(std::size_t mark) noexcept -> value
+        {
+            auto const count = staged(mark);
+            return value::make_sequence(finish(mark), count);
+        }
+
+        // empty when two children share a key (only detected here with SortedKeys)
+        auto finish_mapping(std::size_t mark) noexcept -> std::optional<value>
+        {
+            auto const count = staged(mark);
+            return this->index_mapping(finish(mark), count);
+        }
+
+        // room for `count` contiguous bytes in the current arena block,
+        // starting a new block if needed — call before reading chars_size_
+        // as the start of a string
+        [[nodiscard]] auto can_store(std::size_t count) noexcept -> bool
+        {
+            if (block_ && chars_size_ + count <= block_->size_)
+                return true;
+            auto const size = std::max({count, block_ ? block_->size_ * 2 : 0, first_block_size});
+            try
+            {
+                auto *b = ::new (resource_->allocate(sizeof(block) + size, alignof(block))) block{block_, size, 0};
+                if (block_)
+                    block_->used_ = chars_size_;
+                block_ = b;
+                chars_size_ = 0;
+                return true;
+            }
+            catch (std::bad_alloc const &)
+            {
+                return false;
+            }
+        }
+
+        // append to the arena — caller checks can_store() first
+        auto append(char c) noexcept -> void { chars()[chars_size_++] = c; }
+
+        auto append(std::string_view run) noexcept -> void
+        {
+            std::ranges::copy(run, chars() + chars_size_);
+            chars_size_ += run.size();
+        }
+
+        // finish the string appended since offset `start`, reusing an
+        // interned copy of the same bytes if there is one
+        auto commit(std::size_t start) noexcept -> string_ref
+        {
+            string_ref s{chars() + start, static_cast<std::uint32_t>(chars_size_ - start), true};
+            auto const hash = hash_string(s.view());
+            auto id = strings_.find(s.view(), hash);
+            if (id != strings_.npos)
+            {
+                chars_size_ = start;
+                return strings_[id];
+            }
+            try
+            {
+                strings_.intern(kept(s), hash);
+            }
+            catch (std::bad_alloc const &)
+            {
+                // only the dedupe of later copies is lost
+            }
+            return s;
+        }
+
+    private:
+        friend document_lookup<pmr_document>;
+
+        // an arena block's header; its characters follow it
+        struct block
+        {
+            block *prev_;
+            std::size_t size_;
+            std::size_t used_; // set once a newer block takes over
+        };
+
+        static constexpr std::size_t first_block_size = 4096;
+
+        std::pmr::vector<std::uint32_t> staged_keys_;
+        std::pmr::vector<value> staged_nodes_;
+        std::size_t reserved_{0}; // pool room in every column
+        std::pmr::memory_resource *resource_;
+        block *block_{nullptr};
+
+        auto chars() const noexcept -> char * { return reinterpret_cast<char *>(block_ + 1); }
+
+        // blocks never move, so strings are stored as the pointers the
+        // parser hands over and resolve to themselves
+        static auto kept(string_ref s) noexcept -> string_ref
+        {
+            s.in_arena_ = false;
+            return s;
+        }
+
+        static auto kept(value v) noexcept -> value
+        {
+            v.in_arena_ = false;
+            return v;
+        }
+
+        auto arena() const noexcept -> char const * { return nullptr; }
+
+        static auto stored_string(value const &node) noexcept -> std::string_view { return node.as_string(); }
+
+        auto key_id(std::string_view key, std::uint32_t hash) const noexcept -> std::uint32_t
+        {
+            return strings_.find(key, hash);
+        }
+
+        // the pool keeps room for every staged child, so finish() only
+        // moves them
+        auto stage_id(std::uint32_t id, value const &v) noexcept -> bool
+        {
+            try
+            {
+                auto const needed = pool_size_ + staged_keys_.size() + 1;
+                if (needed > reserved_)
+                {
+                    auto const capacity = std::max<std::size_t>(needed * 2, 64);
+                    keys_.reserve(capacity);
+                    nodes_.reserve(capacity);
+                    if constexpr (SortedKeys)
+                        order_.reserve(capacity);
+                    reserved_ = capacity;
+                }
+                staged_keys_.push_back(id);
+                try
+                {
+                    staged_nodes_.push_back(v);
+                }
+                catch (std::bad_alloc const &)
+                {
+                    staged_keys_.pop_back();
+                    throw;
+                }
+                return true;
+            }
+            catch (std::bad_alloc const &)
+            {
+                return false;
+            }
+        }
+
+        auto reserve_index(std::size_t words) noexcept -> bool
+        {
+            try
+            {
+                if (words > index_.size())
+                    index_.resize(std::max(words, index_.size() * 2));
+                return true;
+            }
+            catch (std::bad_alloc const &)
+            {
+                return false;
+            }
+        }
+    };
+
+    // the pmr_document `Opts` selects
+    template <data::options Opts>
+    using options_pmr_document = pmr_document<Opts.sorted_keys>;
+
+} // namespace data::detail
@@ -0,0 +1,239 @@
+#pragma once
+
+// Event-streaming "document": the parsers drive it exactly as they drive a
+// document, but instead of keeping nodes it reports each key, scalar and
+// container boundary to a handler as it is parsed. Memory use is one frame
+// per open container and a scratch buffer for the string being decoded,
+// whatever the size of the input.
+
+#include <immutable_data/detail/types.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <variant>
+
+namespace data::detail
+{
+
+    // Handlers implement any of these; events without a member are skipped
+    //   on_begin_mapping()  on_end_mapping()  on_key(std::string_view)
+    //   on_begin_sequence() on_end_sequence()
+    //   on_null() on_bool(bool) on_int(std::int64_t) on_float(double)
+    //   on_string(std::string_view)
+    // Strings passed to on_key and on_string are only valid during the call.
+    template <typename Handler>
+    class sax_document
+    {
+    public:
+        value root_{};
+        std::size_t chars_size_{0};
+
+        constexpr explicit sax_document(Handler &handler) noexcept : handler_{&handler} {}
+
+        constexpr auto set_root(value const &v) noexcept -> void { root_ = v; }
+
+        // --- event_sink ---
+
+        // open a container; an XML element opens with kind null and only
+        // begins a mapping once something is staged in it
+        constexpr auto open(value::kind kind) noexcept -> std::size_t
+        {
+            if (depth_ > 0)
+                begin(frames_[depth_ - 1]);
+            auto &f = frames_[depth_];
+            f = frame{0, kind, false, false};
+            if (kind != value::kind::null)
+                begin(f);
+            return depth_++;
+        }
+
+        // the key the next value belongs to, reported before the value is
+        // parsed; the root element's tag name has no container to belong to
+        constexpr auto announce(string_ref key) noexcept -> void
+        {
+            if (depth_ == 0)
+                return;
+            auto &f = frames_[depth_ - 1];
+            begin(f);
+            emit_key(key);
+            f.keyed_ = true;
+            chars_size_ = 0;
+        }
+
+        // an opened XML element turned out to be a scalar
+        constexpr auto drop(std::size_t mark) noexcept -> void { depth_ = mark; }
+
+        // --- document protocol ---
+
+        [[nodiscard]] constexpr auto staged(std::size_t mark) const noexcept -> std::size_t
+        {
+            return frames_[mark].count_;
+        }
+
+        // duplicates are not tracked: nothing is kept to compare against
+        [[nodiscard]] constexpr auto is_staged(std::size_t, std::string_view) const noexcept -> bool
+        {
+            return false;
+        }
+
+        [[nodiscard]] constexpr auto stage(value const &v) noexcept -> bool
+        {
+            auto &f = frames_[depth_ - 1];
+            begin(f);
+            emit_scalar(v);
+            ++f.count_;
+            chars_size_ = 0;
+            return true;
+        }
+
+        [[nodiscard]] constexpr auto stage(string_ref key, value const &v) noexcept -> bool
+        {
+            auto &f = frames_[depth_ - 1];
+            begin(f);
+            if (!f.keyed_)
+                emit_key(key);
+            f.keyed_ = false;
+            emit_scalar(v);
+            ++f.count_;
+            chars_size_ = 0;
+            return true;
+        }
+
+        constexpr auto finish_sequence(std::size_t mark) noexcept -> value
+        {
+            auto &f = frames_[mark];
+            if (!f.begun_)
+                f.kind_ = value::kind::sequence;
+            begin(f);
+            if constexpr (requires { handler_->on_end_sequence(); })
+                handler_->on_end_sequence();
+            depth_ = mark;
+            return value::make_sequence(0, f.count_);
+        }
+
+        constexpr auto finish_mapping(std::size_t mark) noexcept -> std::optional<value>
+        {
+            auto &f = frames_[mark];
+            if (!f.begun_)
+                f.kind_ = value::kind::mapping;
+            begin(f);
+            if constexpr (requires { handler_->on_end_mapping(); })
+                handler_->on_end_mapping();
+            depth_ = mark;
+            return value::make_mapping(0, f.count_);
+        }
+
+        // scratch room for one decoded string, reused once it is delivered
+        [[nodiscard]] constexpr auto can_store(std::size_t count) const noexcept -> bool
+        {
+            return count <= scratch_.size() - chars_size_;
+        }
+
+        constexpr auto append(char c) noexcept -> void { scratch_[chars_size_++] = c; }
+
+        constexpr auto append(std::string_view run) noexcept -> void
+        {
+            std::ranges::copy(run, scratch_.data() + chars_size_);
+            chars_size_ += run.size();
+        }
+
+        constexpr auto commit(std::size_t start) noexcept -> string_ref
+        {
+            return {scratch_.data() + start, static_cast<std::uint32_t>(chars_size_ - start), true};
+        }
+
+        // report a scalar root — containers have already been streamed
+        constexpr auto finish() noexcept -> void
+        {
+            if (!root_.is_sequence() && !root_.is_mapping())
+                emit_scalar(root_);
+        }
+
+    private:
+        struct frame
+        {
+            std::size_t count_{0};
+            value::kind kind_{value::kind::null};
+            bool begun_{false};
+            bool keyed_{false}; // on_key already sent for the next child
+        };
+
+        Handler *handler_;
+        std::array<frame, MAX_PARSE_DEPTH + 2> frames_{};
+        std::size_t depth_{0};
+        std::array<char, DATA_CT_MAX_CHARS> scratch_{};
+
+        // a kind-null frame with something in it is an XML element's mapping
+        constexpr auto begin(frame &f) noexcept -> void
+        {
+            if (f.begun_)
+                return;
+            f.begun_ = true;
+            if (f.kind_ == value::kind::sequence)
+            {
+                if constexpr (requires { handler_->on_begin_sequence(); })
+                    handler_->on_begin_sequence();
+            }
+            else
+            {
+                f.kind_ = value::kind::mapping;
+                if constexpr (requires { handler_->on_begin_mapping(); })
+                    handler_->on_begin_mapping();
+            }
+        }
+
+        constexpr auto emit_key(string_ref key) noexcept -> void
+        {
+            if constexpr (requires { handler_->on_key(key.view()); })
+                handler_->on_key(key.view());
+        }
+
+        constexpr auto emit_scalar(value const &v) noexcept -> void
+        {
+            switch (v.kind_)
+            {
+            case value::kind::null:
+                if constexpr (requires { handler_->on_null(); })
+                    handler_->on_null();
+                break;
+            case value::kind::boolean:
+                if constexpr (requires { handler_->on_bool(v.as_bool()); })
+                    handler_->on_bool(v.as_bool());
+                break;
+            case value::kind::integer:
+                if constexpr (requires { handler_->on_int(v.as_int()); })
+                    handler_->on_int(v.as_int());
+                break;
+            case value::kind::floating:
+                if constexpr (requires { handler_->on_float(v.as_float()); })
+                    handler_->on_float(v.as_float());
+                break;
+            case value::kind::string:
+                if constexpr (requires { handler_->on_string(v.as_string()); })
+                    handler_->on_string(v.as_string());
+                break;
+            case value::kind::sequence:
+            case value::kind::mapping:
+                break;
+            }
+        }
+    };
+
+    // run the parser of `Format` over `input`, streaming to `handler`
+    template <typename Format, data::options Opts, typename Handler>
+    constexpr auto sax_parse(std::string_view input, Handler &handler) noexcept -> data::parse_error
+    {
+        if (input.empty())
+            return {data::error_code::invalid_syntax, 0, 0};
+        sax_document<Handler> doc{handler};
+        auto r = Format::template parse_into<Opts>(input, doc);
+        if (std::holds_alternative<data::parse_error>(r))
+            return std::get<data::parse_error>(r);
+        doc.finish();
+        return {data::error_code::none, 0, 0};
+    }
+
+} // namespace data::detail
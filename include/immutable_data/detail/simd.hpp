@@ -0,0 +1,152 @@
+#pragma once
+
+// Runtime byte scanners for the lexers' hot loops, 16 or 32 bytes at a time.
+// They are not constexpr: lexers call them under `if !consteval` and keep
+// their scalar loops for compile-time parsing. The instruction set is picked
+// when compiling — AVX2 if enabled, else SSE2 or NEON — and
+// DATA_CT_NO_SIMD forces the scalar loop everywhere.
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if !defined(DATA_CT_NO_SIMD) && (defined(__AVX2__) || defined(__SSE2__))
+#include <immintrin.h>
+#define DATA_CT_SIMD_X86 1
+#elif !defined(DATA_CT_NO_SIMD) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define DATA_CT_SIMD_NEON 1
+#endif
+
+namespace data::detail::simd
+{
+
+#if defined(DATA_CT_SIMD_X86) && defined(__AVX2__)
+    inline constexpr std::size_t width = 32;
+    inline constexpr unsigned bits_per_byte = 1;
+    using chunk = __m256i;
+
+    inline auto load(char const *p) noexcept -> chunk { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+    inline auto eq(chunk c, char ch) noexcept -> chunk { return _mm256_cmpeq_epi8(c, _mm256_set1_epi8(ch)); }
+    inline auto either(chunk a, chunk b) noexcept -> chunk { return _mm256_or_si256(a, b); }
+    inline auto bits(chunk c) noexcept -> std::uint64_t
+    {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(c));
+    }
+#elif defined(DATA_CT_SIMD_X86)
+    inline constexpr std::size_t width = 16;
+    inline constexpr unsigned bits_per_byte = 1;
+    using chunk = __m128i;
+
+    inline auto load(char const *p) noexcept -> chunk { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+    inline auto eq(chunk c, char ch) noexcept -> chunk { return _mm_cmpeq_epi8(c, _mm_set1_epi8(ch)); }
+    inline auto either(chunk a, chunk b) noexcept -> chunk { return _mm_or_si128(a, b); }
+    inline auto bits(chunk c) noexcept -> std::uint64_t
+    {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(c));
+    }
+#elif defined(DATA_CT_SIMD_NEON)
+    inline constexpr std::size_t width = 16;
+    inline constexpr unsigned bits_per_byte = 4; // no movemask: narrow to a nibble per byte
+    using chunk = uint8x16_t;
+
+    inline auto load(char const *p) noexcept -> chunk { return vld1q_u8(reinterpret_cast<std::uint8_t const *>(p)); }
+    inline auto eq(chunk c, char ch) noexcept -> chunk { return vceqq_u8(c, vdupq_n_u8(static_cast<std::uint8_t>(ch))); }
+    inline auto either(chunk a, chunk b) noexcept -> chunk { return vorrq_u8(a, b); }
+    inline auto bits(chunk c) noexcept -> std::uint64_t
+    {
+        return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(c), 4)), 0);
+    }
+#endif
+
+#if defined(DATA_CT_SIMD_X86) || defined(DATA_CT_SIMD_NEON)
+    inline constexpr bool enabled = true;
+    inline constexpr std::uint64_t all_bits = width * bits_per_byte == 64 ? ~std::uint64_t{0}
+                                                                          : (std::uint64_t{1} << (width * bits_per_byte)) - 1;
+
+    template <char C, char... Cs>
+    inline auto eq_any(chunk c) noexcept -> chunk
+    {
+        if constexpr (sizeof...(Cs) == 0)
+            return eq(c, C);
+        else
+            return either(eq(c, C), eq_any<Cs...>(c));
+    }
+#else
+    inline constexpr bool enabled = false;
+#endif
+
+    // index of the first byte at or after `pos` that is one of Cs (or, with
+    // Negate, that is none of them); input.size() if there is none
+    template <bool Negate, char... Cs>
+    inline auto find(std::string_view input, std::size_t pos) noexcept -> std::size_t
+    {
+        // most runs are short: settle them before loading a chunk
+        for (auto const stop = pos + 8 < input.size() ? pos + 8 : input.size(); pos < stop; ++pos)
+        {
+            bool const hit = ((input[pos] == Cs) || ...);
+            if (hit != Negate)
+                return pos;
+        }
+#if defined(DATA_CT_SIMD_X86) || defined(DATA_CT_SIMD_NEON)
+        for (; pos + width <= input.size(); pos += width)
+        {
+            auto m = bits(eq_any<Cs...>(load(input.data() + pos)));
+            if constexpr (Negate)
+                m ^= all_bits;
+            if (m != 0)
+                return pos + static_cast<std::size_t>(std::countr_zero(m)) / bits_per_byte;
+        }
+#endif
+        for (; pos < input.size(); ++pos)
+        {
+            bool const hit = ((input[pos] == Cs) || ...);
+            if (hit != Negate)
+                return pos;
+        }
+        return input.size();
+    }
+
+} // namespace data::detail::simd
+
+namespace data::detail
+{
+
+    // first '"' or '\\' at or after `pos` — the end of a JSON string run
+    inline auto find_quote_or_backslash(std::string_view input, std::size_t pos) noexcept -> std::size_t
+    {
+        return simd::find<false, '"', '\\'>(input, pos);
+    }
+
+    // first '\\' at or after `pos` — the end of an escape-free run
+    inline auto find_backslash(std::string_view input, std::size_t pos) noexcept -> std::size_t
+    {
+        return simd::find<false, '\\'>(input, pos);
+    }
+
+    // first byte at or after `pos` that is not JSON whitespace
+    inline auto skip_json_space(std::string_view input, std::size_t pos) noexcept -> std::size_t
+    {
+        return simd::find<true, ' ', '\t', '\n', '\r'>(input, pos);
+    }
+
+    // first byte at or after `pos` that is not YAML separation space
+    inline auto skip_yaml_space(std::string_view input, std::size_t pos) noexcept -> std::size_t
+    {
+        return simd::find<true, ' ', '\t', '\n'>(input, pos);
+    }
+
+    // first byte at or after `pos` that is not ' ' — the end of an indent
+    inline auto skip_spaces(std::string_view input, std::size_t pos) noexcept -> std::size_t
+    {
+        return simd::find<true, ' '>(input, pos);
+    }
+
+    // first '\n' at or after `pos` — the end of a comment or line
+    inline auto find_newline(std::string_view input, std::size_t pos) noexcept -> std::size_t
+    {
+        return simd::find<false, '\n'>(input, pos);
+    }
+
+} // namespace data::detail
@@ -1,9 +1,8 @@
 #pragma once
 
-// Compile-time TOML lexer — tokenizes TOML input into a fixed-size token array
+// Compile-time TOML lexer — produces tokens on demand for the parser
 
 #include <immutable_data/detail/types.hpp>
-#include <array>
 #include <string_view>
 #include <variant>
 
@@ -12,61 +11,55 @@ namespace data::toml::detail
 
     using namespace data::detail;
 
-    template <std::size_t MaxTokens = 1024>
     class lexer
     {
     public:
         struct state
         {
             std::size_t position{0};
-            std::size_t line{1};
-            std::size_t column{1};
         };
 
-        constexpr lexer() noexcept = default;
+        constexpr explicit lexer(std::string_view input) noexcept : input_{input} {}
 
-        constexpr auto tokenize(std::string_view input) noexcept -> std::variant<token_array<MaxTokens>, data::parse_error>
-        {
-            token_array<MaxTokens> tokens{};
-            std::size_t token_count = 0;
-            state s{};
+        [[nodiscard]] constexpr auto input() const noexcept -> std::string_view { return input_; }
 
-            while (!at_end(input, s) && token_count < MaxTokens)
+        // the next token, or eof once the input is consumed — the parser pulls
+        // tokens one at a time, so nothing is buffered
+        constexpr auto next() noexcept -> std::variant<token, data::parse_error>
+        {
+            while (true)
             {
-                skip_whitespace(input, s);
+                skip_whitespace(input_, s_);
 
-                if (at_end(input, s))
-                    break;
+                if (at_end(input_, s_))
+                    return token{token_type::eof, s_.position, 0};
 
                 // Skip comments
-                if (peek(input, s) == '#')
+                if (peek(input_, s_) == '#')
                 {
-                    while (!at_end(input, s) && peek(input, s) != '\n')
-                        advance(input, s);
+                    while (!at_end(input_, s_) && peek(input_, s_) != '\n')
+                        advance(input_, s_);
                     continue;
                 }
 
                 // Skip newlines (they're not significant for our parser)
-                if (peek(input, s) == '\n' || peek(input, s) == '\r')
+                if (peek(input_, s_) == '\n' || peek(input_, s_) == '\r')
                 {
-                    if (peek(input, s) == '\r')
-                        advance(input, s);
-                    if (!at_end(input, s) && peek(input, s) == '\n')
-                        advance(input, s);
+                    if (peek(input_, s_) == '\r')
+                        advance(input_, s_);
+                    if (!at_end(input_, s_) && peek(input_, s_) == '\n')
+                        advance(input_, s_);
                     continue;
                 }
 
-                auto token_result = next_token(input, s);
-                if (std::holds_alternative<data::parse_error>(token_result))
-                    return std::get<data::parse_error>(token_result);
-
-                tokens[token_count++] = std::get<token>(token_result);
+                auto const start = s_.position;
+                auto r = next_token(input_, s_);
+                // a token records a 32-bit offset and a 24-bit length
+                if (std::holds_alternative<token>(r) &&
+                    (s_.position > token::max_offset || s_.position - start > token::max_length))
+                    return error_at(input_, start, data::error_code::string_overflow);
+                return r;
             }
-
-            if (token_count < MaxTokens)
-                tokens[token_count] = token{token_type::eof, {}, s.line, s.column};
-
-            return tokens;
         }
 
     private:
@@ -80,21 +73,16 @@ namespace data::toml::detail
             return at_end(input, s) ? '\0' : input[s.position];
         }
 
+        static constexpr auto peek_next(std::string_view input, const state &s) noexcept -> char
+        {
+            return (s.position + 1 >= input.size()) ? '\0' : input[s.position + 1];
+        }
+
         static constexpr auto advance(std::string_view input, state &s) noexcept -> char
         {
             if (at_end(input, s))
                 return '\0';
-            char c = input[s.position++];
-            if (c == '\n')
-            {
-                ++s.line;
-                s.column = 1;
-            }
-            else
-            {
-                ++s.column;
-            }
-            return c;
+            return input[s.position++];
         }
 
         static constexpr auto skip_whitespace(std::string_view input, state &s) noexcept -> void
@@ -102,7 +90,7 @@ namespace data::toml::detail
             while (!at_end(input, s))
             {
                 char c = peek(input, s);
-                if (c == ' ' || c == '\t')
+                if (is_class(c, char_class::blank))
                     advance(input, s);
                 else
                     break;
@@ -112,32 +100,31 @@ namespace data::toml::detail
         static constexpr auto next_token(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
             char c = peek(input, s);
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
+            std::size_t start_pos = s.position;
 
             switch (c)
             {
             case '=':
                 advance(input, s);
-                return token{token_type::equals, "=", start_line, start_column};
+                return token{token_type::equals, start_pos, 1};
             case '.':
                 advance(input, s);
-                return token{token_type::dot, ".", start_line, start_column};
+                return token{token_type::dot, start_pos, 1};
             case '[':
                 advance(input, s);
-                return token{token_type::sequence_start, "[", start_line, start_column};
+                return token{token_type::sequence_start, start_pos, 1};
             case ']':
                 advance(input, s);
-                return token{token_type::sequence_end, "]", start_line, start_column};
+                return token{token_type::sequence_end, start_pos, 1};
             case '{':
                 advance(input, s);
-                return token{token_type::mapping_start, "{", start_line, start_column};
+                return token{token_type::mapping_start, start_pos, 1};
             case '}':
                 advance(input, s);
-                return token{token_type::mapping_end, "}", start_line, start_column};
+                return token{token_type::mapping_end, start_pos, 1};
             case ',':
                 advance(input, s);
-                return token{token_type::comma, ",", start_line, start_column};
+                return token{token_type::comma, start_pos, 1};
             case '"':
                 return parse_basic_string(input, s);
             case '\'':
@@ -145,23 +132,16 @@ namespace data::toml::detail
             default:
                 if (c == '-' || c == '+' || is_digit(c))
                     return parse_number(input, s);
-                if (is_bare_key_char(c))
+                if (is_class(c, char_class::bare_key))
                     return parse_bare_key(input, s);
                 break;
             }
 
-            return data::parse_error{data::error_code::unexpected_token, s.line, s.column};
-        }
-
-        static constexpr auto is_bare_key_char(char c) noexcept -> bool
-        {
-            return is_alnum(c) || c == '-' || c == '_';
+            return error_at(input, s.position, data::error_code::unexpected_token);
         }
 
         static constexpr auto parse_basic_string(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             advance(input, s); // skip opening "
@@ -171,7 +151,7 @@ namespace data::toml::detail
                 {
                     advance(input, s);
                     if (at_end(input, s))
-                        return data::parse_error{data::error_code::unterminated_string, start_line, start_column};
+                        return error_at(input, start_pos, data::error_code::unterminated_string);
                     advance(input, s);
                 }
                 else
@@ -181,17 +161,14 @@ namespace data::toml::detail
             }
 
             if (at_end(input, s) || peek(input, s) == '\n')
-                return data::parse_error{data::error_code::unterminated_string, start_line, start_column};
+                return error_at(input, start_pos, data::error_code::unterminated_string);
 
             advance(input, s); // skip closing "
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
-            return token{token_type::quoted_string, value, start_line, start_column};
+            return token{token_type::quoted_string, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_literal_string(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             advance(input, s); // skip opening '
@@ -199,18 +176,15 @@ namespace data::toml::detail
                 advance(input, s);
 
             if (at_end(input, s) || peek(input, s) == '\n')
-                return data::parse_error{data::error_code::unterminated_string, start_line, start_column};
+                return error_at(input, start_pos, data::error_code::unterminated_string);
 
             advance(input, s); // skip closing '
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
             // Use quoted_string type — parser strips quotes and skips escape processing for literals
-            return token{token_type::literal_string, value, start_line, start_column};
+            return token{token_type::literal_string, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_number(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             if (peek(input, s) == '-' || peek(input, s) == '+')
@@ -223,17 +197,25 @@ namespace data::toml::detail
                 if (rest.starts_with("inf"))
                 {
                     for (int i = 0; i < 3; ++i) advance(input, s);
-                    std::string_view value = input.substr(start_pos, s.position - start_pos);
-                    return token{token_type::float_literal, value, start_line, start_column};
+                    return token{token_type::float_literal, start_pos, s.position - start_pos};
                 }
                 if (rest.starts_with("nan"))
                 {
                     for (int i = 0; i < 3; ++i) advance(input, s);
-                    std::string_view value = input.substr(start_pos, s.position - start_pos);
-                    return token{token_type::float_literal, value, start_line, start_column};
+                    return token{token_type::float_literal, start_pos, s.position - start_pos};
                 }
             }
 
+            // 0x, 0o and 0b literals; the parser checks the digits against the base
+            if (peek(input, s) == '0' && (peek_next(input, s) == 'x' || peek_next(input, s) == 'o' || peek_next(input, s) == 'b'))
+            {
+                advance(input, s);
+                advance(input, s);
+                while (!at_end(input, s) && (is_hex(peek(input, s)) || peek(input, s) == '_'))
+                    advance(input, s);
+                return token{token_type::integer_literal, start_pos, s.position - start_pos};
+            }
+
             while (!at_end(input, s) && (is_digit(peek(input, s)) || peek(input, s) == '_'))
                 advance(input, s);
 
@@ -255,27 +237,29 @@ namespace data::toml::detail
                     advance(input, s);
             }
 
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
             token_type type = is_float ? token_type::float_literal : token_type::integer_literal;
-            return token{type, value, start_line, start_column};
+            return token{type, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_bare_key(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
-            while (!at_end(input, s) && is_bare_key_char(peek(input, s)))
+            while (!at_end(input, s) && is_class(peek(input, s), char_class::bare_key))
                 advance(input, s);
 
             std::string_view value = input.substr(start_pos, s.position - start_pos);
 
             if (value == "true" || value == "false")
-                return token{token_type::boolean_literal, value, start_line, start_column};
+                return token{token_type::boolean_literal, start_pos, s.position - start_pos};
+            if (value == "inf" || value == "nan")
+                return token{token_type::float_literal, start_pos, s.position - start_pos};
 
-            return token{token_type::string_literal, value, start_line, start_column};
+            return token{token_type::string_literal, start_pos, s.position - start_pos};
         }
+
+        std::string_view input_;
+        state s_{};
     };
 
 } // namespace data::toml::detail
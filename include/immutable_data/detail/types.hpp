@@ -1,9 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <memory> // for std::construct_at, std::destroy_at
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string_view>
+#include <type_traits>
 #include <utility>
+#include <immutable_data/detail/fixed_string.hpp>
 #include <immutable_data/detail/string_storage.hpp>
 #include <immutable_data/detail/utils.hpp>
 
@@ -20,6 +26,20 @@
 #define DATA_CT_MAX_NODES (DATA_CT_MAX_ITEMS * 4)
 #endif
 
+#ifndef DATA_CT_MAX_CHARS
+#define DATA_CT_MAX_CHARS (DATA_CT_MAX_NODES * 16)
+#endif
+
+// mappings with at least this many keys get a perfect-hash index
+#ifndef DATA_CT_INDEX_MIN_KEYS
+#define DATA_CT_INDEX_MIN_KEYS 16
+#endif
+
+// segments in a data::path
+#ifndef DATA_CT_MAX_PATH_SEGMENTS
+#define DATA_CT_MAX_PATH_SEGMENTS 16
+#endif
+
 namespace data
 {
     enum class [[nodiscard]] error_code : std::uint8_t
@@ -39,6 +59,8 @@ namespace data
         pool_overflow,
         string_overflow,
         max_depth_exceeded,
+        integer_overflow,
+        io_error,
     };
 
     constexpr auto error_message(error_code ec) noexcept -> std::string_view
@@ -60,6 +82,8 @@ namespace data
         case error_code::pool_overflow:           return "node pool overflow";
         case error_code::string_overflow:         return "string capacity exceeded";
         case error_code::max_depth_exceeded:      return "maximum nesting depth exceeded";
+        case error_code::integer_overflow:        return "integer out of range";
+        case error_code::io_error:                return "file could not be read";
         }
         return "unknown error";
     }
@@ -77,6 +101,148 @@ namespace data
 
         constexpr bool operator==(parse_error const &) const noexcept = default;
     };
+
+    // where a stream_parser stands after a chunk
+    enum class stream_status : std::uint8_t
+    {
+        need_more, // the document is not complete yet
+        done,      // the document is complete; later input is not read
+        error,     // see error()
+    };
+
+    // per-call parse options, passed as a template argument:
+    // parse<data::options{.sorted_keys = true}>("...")
+    struct options
+    {
+        // keep each mapping's key order sorted for binary-search lookup
+        // instead of building hash indexes; duplicates are found by sorting
+        bool sorted_keys{false};
+        // decimal integers outside int64 become doubles instead of an
+        // integer_overflow error
+        bool overflow_to_float{false};
+        // keys and strings without escapes view the input instead of being
+        // copied into the document, which then must not outlive the input
+        bool reference_source{false};
+    };
+
+    // a mapping key with its hash computed once, for find() calls repeated
+    // in a loop; the name must outlive the key
+    struct key
+    {
+        std::string_view name_{};
+        std::uint32_t hash_{detail::hash_string({})};
+
+        constexpr key() noexcept = default;
+        constexpr explicit key(std::string_view name) noexcept
+            : name_{name}, hash_{detail::hash_string(name)}
+        {
+        }
+
+        [[nodiscard]] constexpr auto name() const noexcept -> std::string_view { return name_; }
+        [[nodiscard]] constexpr auto hash() const noexcept -> std::uint32_t { return hash_; }
+    };
+
+    // a lookup path split, unescaped and hashed once, for repeated
+    // doc.resolve(p) on any document. Text starting with '/' is a JSON
+    // Pointer ("/services/0/port", with ~0 and ~1 escapes); anything else is
+    // dotted ("services.0.port"). A segment of digits indexes a sequence and
+    // names a key in a mapping. The path owns a copy of its segments, so the
+    // text need not outlive it; valid() is false if the text is malformed or
+    // exceeds DATA_CT_MAX_PATH_SEGMENTS or DATA_CT_MAX_STRING_SIZE.
+    struct path
+    {
+        static constexpr std::uint32_t no_index = ~std::uint32_t{0};
+
+        struct segment
+        {
+            std::uint16_t offset{0};
+            std::uint16_t size{0};
+            std::uint32_t hash{0};
+            std::uint32_t index{no_index}; // value of an all-digit segment
+        };
+
+        std::array<char, DATA_CT_MAX_STRING_SIZE> chars_{};
+        std::size_t chars_size_{0};
+        std::array<segment, DATA_CT_MAX_PATH_SEGMENTS> segments_{};
+        std::size_t size_{0};
+        bool valid_{true};
+
+        constexpr path() noexcept = default;
+
+        constexpr explicit path(std::string_view text) noexcept
+        {
+            bool const pointer = !text.empty() && text.front() == '/';
+            char const separator = pointer ? '/' : '.';
+            if (pointer)
+                text.remove_prefix(1);
+            else if (text.empty())
+                return; // the root
+            while (valid_)
+            {
+                auto const end = text.find(separator);
+                auto const raw = text.substr(0, end);
+                if (!pointer && raw.empty())
+                    valid_ = false;
+                else
+                    add_segment(raw, pointer);
+                if (end == std::string_view::npos)
+                    break;
+                text.remove_prefix(end + 1);
+            }
+        }
+
+        [[nodiscard]] constexpr auto valid() const noexcept -> bool { return valid_; }
+        [[nodiscard]] constexpr auto size() const noexcept -> std::size_t { return size_; }
+
+        [[nodiscard]] constexpr auto name(std::size_t i) const noexcept -> std::string_view
+        {
+            return {chars_.data() + segments_[i].offset, segments_[i].size};
+        }
+
+    private:
+        constexpr void add_segment(std::string_view raw, bool pointer) noexcept
+        {
+            if (size_ == segments_.size())
+            {
+                valid_ = false;
+                return;
+            }
+            auto &seg = segments_[size_++];
+            seg.offset = static_cast<std::uint16_t>(chars_size_);
+            for (std::size_t i = 0; i < raw.size(); ++i)
+            {
+                char c = raw[i];
+                if (pointer && c == '~')
+                {
+                    if (i + 1 == raw.size() || (raw[i + 1] != '0' && raw[i + 1] != '1'))
+                    {
+                        valid_ = false;
+                        return;
+                    }
+                    c = raw[++i] == '0' ? '~' : '/';
+                }
+                if (chars_size_ == chars_.size())
+                {
+                    valid_ = false;
+                    return;
+                }
+                chars_[chars_size_++] = c;
+            }
+            seg.size = static_cast<std::uint16_t>(chars_size_ - seg.offset);
+
+            auto const text = name(size_ - 1);
+            seg.hash = detail::hash_string(text);
+            std::uint64_t idx = 0;
+            for (char c : text)
+            {
+                if (!detail::is_digit(c) || idx > no_index)
+                    return;
+                idx = idx * 10 + static_cast<std::uint64_t>(c - '0');
+            }
+            if (!text.empty() && idx < no_index)
+                seg.index = static_cast<std::uint32_t>(idx);
+        }
+    };
 }
 
 namespace data::detail
@@ -114,21 +280,45 @@ namespace data::detail
         invalid
     };
 
+    // a span of the input — 32-bit offset, 24-bit length and the type in
+    // 8 bytes; line and column are only worked out when an error is reported
     struct token
     {
-        token_type type_{token_type::invalid};
-        std::string_view value_{};
-        std::size_t line_{0};
-        std::size_t column_{0};
+        static constexpr std::size_t max_offset = ~std::uint32_t{0};
+        static constexpr std::size_t max_length = (std::size_t{1} << 24) - 1;
+
+        std::uint32_t offset_{0};
+        std::uint32_t length_ : 24 {0};
+        token_type type_ : 8 {token_type::invalid};
 
         constexpr token() = default;
-        constexpr token(token_type type, std::string_view value,
-                        std::size_t line, std::size_t column) noexcept
-            : type_{type}, value_{value}, line_{line}, column_{column} {}
+        constexpr token(token_type type, std::size_t offset, std::size_t length) noexcept
+            : offset_{static_cast<std::uint32_t>(offset)}, length_{static_cast<std::uint32_t>(length)}, type_{type} {}
+
+        [[nodiscard]] constexpr auto text(std::string_view input) const noexcept -> std::string_view
+        {
+            return {input.data() + offset_, length_};
+        }
     };
+    static_assert(sizeof(token) == 8);
 
-    template <std::size_t MaxTokens = 1024>
-    using token_array = std::array<token, MaxTokens>;
+    // 1-based column of `offset`, counted back to the start of its line
+    constexpr auto column_at(std::string_view input, std::size_t offset) noexcept -> std::size_t
+    {
+        auto const nl = offset == 0 ? std::string_view::npos : input.rfind('\n', offset - 1);
+        return nl == std::string_view::npos ? offset + 1 : offset - nl;
+    }
+
+    // error at `offset`, with its line and column found by rescanning the input
+    constexpr auto error_at(std::string_view input, std::size_t offset, data::error_code ec) noexcept
+        -> data::parse_error
+    {
+        std::size_t line = 1;
+        for (std::size_t i = 0; i < offset && i < input.size(); ++i)
+            if (input[i] == '\n')
+                ++line;
+        return {ec, line, column_at(input, offset)};
+    }
 
     // scalar type aliases
     struct null_t
@@ -139,16 +329,52 @@ namespace data::detail
     using boolean = bool;
     using integer = std::int64_t;
     using floating = double;
-    using string_type = string_storage<DATA_CT_MAX_STRING_SIZE>;
+
+    // string reference — bytes in the source text or in a document's
+    // character arena. While parsing, an arena string points at its bytes; a
+    // document stores it as offset_ into its arena instead, so a document
+    // holds no pointers into itself and copies as plain data.
+    struct string_ref
+    {
+        union
+        {
+            char const *data_{nullptr};
+            std::size_t offset_; // stored, in_arena_: from the start of the arena
+        };
+        std::uint32_t size_{0};
+        bool in_arena_{false};
+
+        [[nodiscard]] constexpr auto view() const noexcept -> std::string_view { return {data_, size_}; }
+    };
+
+    // a stored string: its bytes, finding arena strings in `chars`
+    constexpr auto stored_view(string_ref const &s, char const *chars) noexcept -> std::string_view
+    {
+        return s.in_arena_ ? std::string_view{chars + s.offset_, s.size_} : s.view();
+    }
+
+    // reference to bytes that live in the parsed input (or any static storage)
+    constexpr auto source_ref(std::string_view sv) noexcept -> string_ref
+    {
+        return {sv.data(), static_cast<std::uint32_t>(sv.size()), false};
+    }
 
     // container reference — index range into document's node pool
     struct container_ref
     {
-        std::size_t start;
-        std::size_t count;
+        std::uint32_t start;
+        std::uint32_t count;
     };
 
-    // value — flat tagged union for any hierarchical data (YAML, JSON, etc.)
+    // value — flat tagged union for any hierarchical data (YAML, JSON, etc.),
+    // packed into 16 bytes: an 8-byte payload (inline scalar, string pointer,
+    // node-relative offset or child range), the string length, the kind tag
+    // and two flags. A parser hands over an arena string as a pointer with
+    // in_arena_ set; a fixed-size document stores it as the distance from the
+    // node to its bytes, with relative_ set, so the node reads its own string
+    // wherever the document is copied. Such a node is read in place: a copy
+    // of it elsewhere no longer finds its bytes. For a mapping, size_ is the
+    // offset + 1 of its hash index in the document (0 if it has none).
     struct value
     {
         enum class kind : std::uint8_t
@@ -162,97 +388,21 @@ namespace data::detail
             mapping
         };
 
-        kind kind_{kind::null};
-
         union data_t
         {
-            constexpr data_t() noexcept : dummy_{} {}
-            constexpr ~data_t() noexcept {}
-            char dummy_;
+            char dummy_{};
             bool bool_;
             std::int64_t int_;
             double float_;
-            string_type str_;
+            char const *str_;
+            std::size_t offset_;
             container_ref children_;
         } data_{};
 
-        constexpr value() noexcept = default;
-
-        constexpr value(value const &o) noexcept : kind_{o.kind_}
-        {
-            switch (kind_)
-            {
-            case kind::string:
-                std::construct_at(&data_.str_, o.data_.str_);
-                break;
-            case kind::boolean:
-                data_.bool_ = o.data_.bool_;
-                break;
-            case kind::integer:
-                data_.int_ = o.data_.int_;
-                break;
-            case kind::floating:
-                data_.float_ = o.data_.float_;
-                break;
-            case kind::sequence:
-            case kind::mapping:
-                data_.children_ = o.data_.children_;
-                break;
-            default:
-                break;
-            }
-        }
-
-        constexpr value(value &&o) noexcept : kind_{o.kind_}
-        {
-            switch (kind_)
-            {
-            case kind::string:
-                std::construct_at(&data_.str_, std::move(o.data_.str_));
-                break;
-            case kind::boolean:
-                data_.bool_ = o.data_.bool_;
-                break;
-            case kind::integer:
-                data_.int_ = o.data_.int_;
-                break;
-            case kind::floating:
-                data_.float_ = o.data_.float_;
-                break;
-            case kind::sequence:
-            case kind::mapping:
-                data_.children_ = o.data_.children_;
-                break;
-            default:
-                break;
-            }
-        }
-
-        constexpr ~value() noexcept
-        {
-            if (kind_ == kind::string)
-                std::destroy_at(&data_.str_);
-        }
-
-        constexpr auto operator=(value const &o) noexcept -> value &
-        {
-            if (this != &o)
-            {
-                std::destroy_at(this);
-                std::construct_at(this, o);
-            }
-            return *this;
-        }
-
-        constexpr auto operator=(value &&o) noexcept -> value &
-        {
-            if (this != &o)
-            {
-                std::destroy_at(this);
-                std::construct_at(this, std::move(o));
-            }
-            return *this;
-        }
+        std::uint32_t size_{0};
+        kind kind_{kind::null};
+        bool in_arena_{false};
+        bool relative_{false};
 
         // factory methods
         static constexpr auto make_null() noexcept -> value { return {}; }
@@ -281,11 +431,25 @@ namespace data::detail
             return v;
         }
 
-        static constexpr auto make_string(string_type s) noexcept -> value
+        static constexpr auto make_string(string_ref s) noexcept -> value
         {
             value v;
             v.kind_ = kind::string;
-            std::construct_at(&v.data_.str_, std::move(s));
+            v.data_.str_ = s.data_;
+            v.size_ = s.size_;
+            v.in_arena_ = s.in_arena_;
+            return v;
+        }
+
+        // a string stored in a document node, its bytes `distance` bytes
+        // past the node itself
+        static constexpr auto make_stored_string(std::size_t distance, std::size_t size) noexcept -> value
+        {
+            value v;
+            v.kind_ = kind::string;
+            v.data_.offset_ = distance;
+            v.size_ = static_cast<std::uint32_t>(size);
+            v.relative_ = true;
             return v;
         }
 
@@ -293,7 +457,7 @@ namespace data::detail
         {
             value v;
             v.kind_ = kind::sequence;
-            v.data_.children_ = {start, count};
+            v.data_.children_ = {static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(count)};
             return v;
         }
 
@@ -301,7 +465,7 @@ namespace data::detail
         {
             value v;
             v.kind_ = kind::mapping;
-            v.data_.children_ = {start, count};
+            v.data_.children_ = {static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(count)};
             return v;
         }
 
@@ -318,27 +482,101 @@ namespace data::detail
         [[nodiscard]] constexpr auto as_bool() const noexcept -> bool { return data_.bool_; }
         [[nodiscard]] constexpr auto as_int() const noexcept -> std::int64_t { return data_.int_; }
         [[nodiscard]] constexpr auto as_float() const noexcept -> double { return data_.float_; }
-        [[nodiscard]] constexpr auto as_string() const noexcept -> std::string_view { return data_.str_.view(); }
+        // a relative string is found from the node's address, which a
+        // constant expression cannot do; the document's get<>() reads it there
+        [[nodiscard]] constexpr auto as_string() const noexcept -> std::string_view
+        {
+            if (!relative_)
+                return {data_.str_, size_};
+            return {reinterpret_cast<char const *>(this) + data_.offset_, size_};
+        }
+        [[nodiscard]] constexpr auto as_string_ref() const noexcept -> string_ref { return {data_.str_, size_, in_arena_}; }
     };
 
-    // pool entry — a value with an optional key (for mapping entries)
+    // key/value pair as produced by the parsers; the document stores keys and
+    // values in separate columns
     struct pool_entry
     {
-        string_type key{};
+        string_ref key{};
         value val_{};
     };
 
+    // interned strings — open-addressed hash index over a dense id table;
+    // id 0 is always the empty string. Strings are kept as their document
+    // stores them, so arena strings are found in the `chars` passed in.
+    template <std::size_t Capacity>
+    struct string_table
+    {
+        static constexpr std::uint32_t npos = ~std::uint32_t{0};
+        static constexpr std::size_t slot_count = std::bit_ceil(Capacity + 1);
+
+        std::array<string_ref, Capacity> strings_{};
+        std::size_t size_{1};
+        std::array<std::uint32_t, slot_count> slots_{}; // id + 1, 0 = free
+
+        [[nodiscard]] constexpr auto operator[](std::uint32_t id) const noexcept -> string_ref const &
+        {
+            return strings_[id];
+        }
+
+        [[nodiscard]] constexpr auto has_room() const noexcept -> bool { return size_ < Capacity; }
+
+        [[nodiscard]] constexpr auto find(std::string_view s, char const *chars) const noexcept -> std::uint32_t
+        {
+            return find(s, hash_string(s), chars);
+        }
+
+        // same, with `hash` == hash_string(s) computed by the caller
+        [[nodiscard]] constexpr auto find(std::string_view s, std::uint32_t hash, char const *chars) const noexcept
+            -> std::uint32_t
+        {
+            if (s.empty())
+                return 0;
+            for (auto slot = hash & (slot_count - 1);; slot = (slot + 1) & (slot_count - 1))
+            {
+                if (slots_[slot] == 0)
+                    return npos;
+                if (stored_view(strings_[slots_[slot] - 1], chars) == s)
+                    return slots_[slot] - 1;
+            }
+        }
+
+        // id of stored string `s`, adding it if new — caller checks has_room() first
+        constexpr auto intern(string_ref s, char const *chars) noexcept -> std::uint32_t
+        {
+            return intern(s, hash_string(stored_view(s, chars)), chars);
+        }
+
+        // same, with `hash` of its bytes computed by the caller
+        constexpr auto intern(string_ref s, std::uint32_t hash, char const *chars) noexcept -> std::uint32_t
+        {
+            if (s.size_ == 0)
+                return 0;
+            auto const text = stored_view(s, chars);
+            auto slot = hash & (slot_count - 1);
+            for (; slots_[slot] != 0; slot = (slot + 1) & (slot_count - 1))
+            {
+                if (stored_view(strings_[slots_[slot] - 1], chars) == text)
+                    return slots_[slot] - 1;
+            }
+            auto id = static_cast<std::uint32_t>(size_++);
+            strings_[id] = s;
+            slots_[slot] = id + 1;
+            return id;
+        }
+    };
+
     // view for iterating sequence/mapping values
     struct value_view
     {
-        pool_entry const *begin_;
-        pool_entry const *end_;
+        value const *begin_;
+        value const *end_;
 
         struct iterator
         {
-            pool_entry const *ptr_;
+            value const *ptr_;
 
-            constexpr auto operator*() const noexcept -> data::detail::value const & { return ptr_->val_; }
+            constexpr auto operator*() const noexcept -> data::detail::value const & { return *ptr_; }
             constexpr auto operator++() noexcept -> iterator & { ++ptr_; return *this; }
             constexpr auto operator!=(iterator const &o) const noexcept -> bool { return ptr_ != o.ptr_; }
             constexpr auto operator==(iterator const &o) const noexcept -> bool { return ptr_ == o.ptr_; }
@@ -356,72 +594,104 @@ namespace data::detail
         data::detail::value const &value;
     };
 
-    // view for iterating mapping key-value pairs
+    // view for iterating mapping key-value pairs; arena keys are found in
+    // `chars_`
     struct entry_view
     {
-        pool_entry const *begin_;
-        pool_entry const *end_;
+        string_ref const *strings_;
+        std::uint32_t const *keys_;
+        value const *values_;
+        std::size_t size_;
+        char const *chars_;
 
         struct iterator
         {
-            pool_entry const *ptr_;
+            string_ref const *strings_;
+            std::uint32_t const *key_;
+            value const *val_;
+            char const *chars_;
 
             constexpr auto operator*() const noexcept -> entry_view_item
             {
-                return {ptr_->key.view(), ptr_->val_};
+                return {stored_view(strings_[*key_], chars_), *val_};
             }
-            constexpr auto operator++() noexcept -> iterator & { ++ptr_; return *this; }
-            constexpr auto operator!=(iterator const &o) const noexcept -> bool { return ptr_ != o.ptr_; }
-            constexpr auto operator==(iterator const &o) const noexcept -> bool { return ptr_ == o.ptr_; }
+            constexpr auto operator++() noexcept -> iterator & { ++key_; ++val_; return *this; }
+            constexpr auto operator!=(iterator const &o) const noexcept -> bool { return key_ != o.key_; }
+            constexpr auto operator==(iterator const &o) const noexcept -> bool { return key_ == o.key_; }
         };
 
-        [[nodiscard]] constexpr auto begin() const noexcept -> iterator { return {begin_}; }
-        [[nodiscard]] constexpr auto end() const noexcept -> iterator { return {end_}; }
-        [[nodiscard]] constexpr auto size() const noexcept -> std::size_t { return end_ - begin_; }
+        [[nodiscard]] constexpr auto begin() const noexcept -> iterator { return {strings_, keys_, values_, chars_}; }
+        [[nodiscard]] constexpr auto end() const noexcept -> iterator
+        {
+            return {strings_, keys_ + size_, values_ + size_, chars_};
+        }
+        [[nodiscard]] constexpr auto size() const noexcept -> std::size_t { return size_; }
     };
 
     // Maximum nesting depth for recursive parsers
     static constexpr std::size_t MAX_PARSE_DEPTH = 64;
 
-    // document — holds the root value and a flat pool of all container children
-    struct document
+    // lookups shared by every document layout. Derived holds root_, the
+    // keys_ and nodes_ columns, strings_, index_ and order_ in contiguous
+    // storage of any kind, and says whether it keeps sorted_keys; build
+    // time index room comes from its reserve_index(). It also finds a key's
+    // id with key_id(), says where stored arena keys start with arena() and
+    // reads a stored string node with stored_string(), which works in a
+    // constant expression too. Lookups hand out the stored nodes themselves.
+    template <typename Derived>
+    struct document_lookup
     {
-        value root_{};
-        std::array<pool_entry, DATA_CT_MAX_NODES> pool_{};
-        std::size_t pool_size_{0};
-
-        constexpr document() noexcept = default;
-
-        constexpr auto alloc(std::size_t count) noexcept -> std::size_t
+        [[nodiscard]] constexpr auto find(value const &v, std::string_view key) const noexcept -> value const *
         {
-            auto start = pool_size_;
-            pool_size_ += count;
-            return start;
+            if (v.kind_ != value::kind::mapping)
+                return nullptr;
+            return find_id(v, self().key_id(key, hash_string(key)));
         }
 
-        [[nodiscard]] constexpr bool can_alloc(std::size_t count) const noexcept
+        // same, without hashing the key again
+        [[nodiscard]] constexpr auto find(value const &v, data::key const &key) const noexcept -> value const *
         {
-            return pool_size_ + count <= DATA_CT_MAX_NODES;
+            if (v.kind_ != value::kind::mapping)
+                return nullptr;
+            return find_id(v, self().key_id(key.name(), key.hash()));
         }
 
-        [[nodiscard]] constexpr auto find(value const &v, std::string_view key) const noexcept
-            -> value const *
+        // child of mapping `v` whose key has interned id `id` (npos: none)
+        [[nodiscard]] constexpr auto find_id(value const &v, std::uint32_t id) const noexcept -> value const *
         {
-            if (v.kind_ != value::kind::mapping)
+            auto const &d = self();
+            if (v.kind_ != value::kind::mapping || id == npos)
+                return nullptr;
+            auto const start = v.data_.children_.start;
+            if constexpr (Derived::sorted_keys)
+            {
+                auto const *order = d.order_.data() + start;
+                auto const *it = std::lower_bound(order, order + v.data_.children_.count, id,
+                                                  [&](std::uint32_t o, std::uint32_t k) { return d.keys_[start + o] < k; });
+                if (it != order + v.data_.children_.count && d.keys_[start + *it] == id)
+                    return &d.nodes_[start + *it];
                 return nullptr;
-            for (std::size_t i = 0; i < v.data_.children_.count; ++i)
+            }
+            if (v.size_ != 0)
             {
-                auto &entry = pool_[v.data_.children_.start + i];
-                if (entry.key.view() == key)
-                    return &entry.val_;
+                auto const *ix = d.index_.data() + (v.size_ - 1);
+                auto const pilot = ix[2 + index_bucket(id, ix[1])];
+                auto const slot = ix[2 + ix[1] + index_slot(id, pilot, ix[0])];
+                if (slot != 0 && d.keys_[start + slot - 1] == id)
+                    return &d.nodes_[start + slot - 1];
+                return nullptr;
+            }
+            for (std::size_t i = start; i < start + v.data_.children_.count; ++i)
+            {
+                if (d.keys_[i] == id)
+                    return &d.nodes_[i];
             }
             return nullptr;
         }
 
-        [[nodiscard]] constexpr auto at(value const &v, std::size_t idx) const noexcept
-            -> value const &
+        [[nodiscard]] constexpr auto at(value const &v, std::size_t idx) const noexcept -> value const &
         {
-            return pool_[v.data_.children_.start + idx].val_;
+            return self().nodes_[v.data_.children_.start + idx];
         }
 
         [[nodiscard]] constexpr auto size(value const &v) const noexcept -> std::size_t
@@ -434,24 +704,628 @@ namespace data::detail
         [[nodiscard]] constexpr auto key_at(value const &v, std::size_t idx) const noexcept
             -> std::string_view
         {
-            return pool_[v.data_.children_.start + idx].key.view();
+            auto const &d = self();
+            return stored_view(d.strings_[d.keys_[v.data_.children_.start + idx]], d.arena());
         }
 
         [[nodiscard]] constexpr auto values(value const &v) const noexcept -> value_view
         {
+            auto const &d = self();
+            auto const *nodes = d.nodes_.data();
             if (v.kind_ != value::kind::sequence && v.kind_ != value::kind::mapping)
-                return {pool_.data(), pool_.data()};
-            auto *base = pool_.data() + v.data_.children_.start;
+                return {nodes, nodes};
+            auto *base = nodes + v.data_.children_.start;
             return {base, base + v.data_.children_.count};
         }
 
         [[nodiscard]] constexpr auto entries(value const &v) const noexcept -> entry_view
         {
+            auto const &d = self();
+            auto const *strings = d.strings_.strings_.data();
             if (v.kind_ != value::kind::mapping)
-                return {pool_.data(), pool_.data()};
-            auto *base = pool_.data() + v.data_.children_.start;
-            return {base, base + v.data_.children_.count};
+                return {strings, d.keys_.data(), d.nodes_.data(), 0, d.arena()};
+            auto const start = v.data_.children_.start;
+            return {strings, d.keys_.data() + start, d.nodes_.data() + start, v.data_.children_.count, d.arena()};
+        }
+
+        // value at a dot-separated path of mapping keys and sequence indexes
+        // ("servers.0.port"), or nullptr if a segment does not resolve
+        [[nodiscard]] constexpr auto find_path(std::string_view path) const noexcept -> value const *
+        {
+            auto const &d = self();
+            value const *v = &d.root_;
+            while (v)
+            {
+                auto const dot = path.find('.');
+                auto const segment = path.substr(0, dot);
+                if (segment.empty())
+                    return nullptr;
+                if (v->kind_ == value::kind::sequence)
+                {
+                    std::size_t idx = 0;
+                    for (char c : segment)
+                    {
+                        if (!is_digit(c) || idx > v->data_.children_.count)
+                            return nullptr;
+                        idx = idx * 10 + static_cast<std::size_t>(c - '0');
+                    }
+                    v = idx < v->data_.children_.count ? &d.nodes_[v->data_.children_.start + idx] : nullptr;
+                }
+                else
+                {
+                    v = find_id(*v, v->kind_ == value::kind::mapping ? d.key_id(segment, hash_string(segment))
+                                                                      : std::uint32_t{npos});
+                }
+                if (dot == std::string_view::npos)
+                    return v;
+                path.remove_prefix(dot + 1);
+            }
+            return nullptr;
+        }
+
+        // the node at `p`, found as find() and at() find it, or nullptr if a
+        // segment does not resolve or p is not valid; segments were split
+        // and hashed when `p` was built
+        [[nodiscard]] constexpr auto resolve(data::path const &p) const noexcept -> value const *
+        {
+            if (!p.valid())
+                return nullptr;
+            auto const &d = self();
+            value const *v = &d.root_;
+            for (std::size_t i = 0; i < p.size() && v; ++i)
+            {
+                auto const &seg = p.segments_[i];
+                if (v->kind_ == value::kind::sequence)
+                    v = seg.index < v->data_.children_.count ? &d.nodes_[v->data_.children_.start + seg.index] : nullptr;
+                else if (v->kind_ == value::kind::mapping)
+                    v = find_id(*v, d.key_id(p.name(i), seg.hash));
+                else
+                    v = nullptr;
+            }
+            return v;
+        }
+
+        // `Path` resolved while compiling, for a constexpr document:
+        // `doc.get<"server.port", int>()` is a constant, and a path that does
+        // not resolve or holds another kind fails to compile. T is `value`,
+        // bool, an integer type, a floating type (integers convert) or
+        // std::string_view.
+        template <fixed_string Path, typename T = value>
+        [[nodiscard]] consteval auto get() const -> T
+        {
+            auto const *v = find_path(Path.view());
+            if (!v)
+                throw "data: path not found";
+            if constexpr (std::is_same_v<T, value>)
+            {
+                // a copy points at its string instead of counting from the node
+                return v->is_string() ? value::make_string(source_ref(self().stored_string(*v))) : *v;
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                if (!v->is_bool())
+                    throw "data: path does not hold a boolean";
+                return v->as_bool();
+            }
+            else if constexpr (std::is_integral_v<T>)
+            {
+                if (!v->is_int())
+                    throw "data: path does not hold an integer";
+                if (!std::in_range<T>(v->as_int()))
+                    throw "data: integer out of range for the requested type";
+                return static_cast<T>(v->as_int());
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                if (v->is_int())
+                    return static_cast<T>(v->as_int());
+                if (!v->is_float())
+                    throw "data: path does not hold a number";
+                return static_cast<T>(v->as_float());
+            }
+            else
+            {
+                static_assert(std::is_same_v<T, std::string_view>, "get<Path, T>: unsupported type");
+                if (!v->is_string())
+                    throw "data: path does not hold a string";
+                return self().stored_string(*v);
+            }
+        }
+
+    protected:
+        // order or index the `count` children of a mapping just finished at
+        // `start`; empty when two children share a key (only detected here
+        // with sorted_keys)
+        constexpr auto index_mapping(std::size_t start, std::size_t count) noexcept -> std::optional<value>
+        {
+            auto &d = self();
+            auto v = value::make_mapping(start, count);
+            if constexpr (Derived::sorted_keys)
+            {
+                auto *order = d.order_.data() + start;
+                for (std::uint32_t i = 0; i < count; ++i)
+                    order[i] = i;
+                std::sort(order, order + count, [&](std::uint32_t a, std::uint32_t b)
+                          { return d.keys_[start + a] < d.keys_[start + b]; });
+                for (std::size_t i = 1; i < count; ++i)
+                    if (d.keys_[start + order[i - 1]] == d.keys_[start + order[i]])
+                        return std::nullopt;
+            }
+            else if (count >= DATA_CT_INDEX_MIN_KEYS)
+            {
+                v.size_ = build_index(start, count);
+            }
+            return v;
+        }
+
+    private:
+        constexpr auto self() const noexcept -> Derived const & { return static_cast<Derived const &>(*this); }
+        constexpr auto self() noexcept -> Derived & { return static_cast<Derived &>(*this); }
+
+        static constexpr std::uint32_t npos = ~std::uint32_t{0};
+
+        static constexpr std::uint32_t index_pending = 0x80000000u;
+        static constexpr std::size_t index_max_bucket = 32;
+        static constexpr std::uint32_t index_max_pilot = 1u << 16;
+
+        static constexpr auto index_bucket(std::uint32_t id, std::uint32_t buckets) noexcept -> std::uint32_t
+        {
+            return mix_hash(id ^ 0x5bd1e995u) & (buckets - 1);
+        }
+
+        static constexpr auto index_slot(std::uint32_t id, std::uint32_t pilot, std::uint32_t slots) noexcept
+            -> std::uint32_t
+        {
+            return mix_hash(id + pilot * 0x9e3779b9u) & (slots - 1);
+        }
+
+        // Hash-and-displace: the children's key ids are split into buckets and
+        // each bucket, largest first, takes the first pilot that sends all its
+        // ids to free slots. Laid out at index_[o] as: slot count, bucket
+        // count, one pilot per bucket, then the slots (child offset + 1, or 0).
+        // Returns o + 1, or 0 when the index does not fit or no pilot is found.
+        constexpr auto build_index(std::size_t start, std::size_t n) noexcept -> std::uint32_t
+        {
+            auto const m = static_cast<std::uint32_t>(std::bit_ceil(n + n / 4));
+            auto const r = static_cast<std::uint32_t>(std::bit_ceil((n + 3) / 4));
+            auto &d = self();
+            auto const o = d.index_size_;
+            if (!d.reserve_index(o + 2 + r + m))
+                return 0;
+            auto *pilots = d.index_.data() + o + 2;
+            auto *slots = pilots + r;
+            for (std::size_t i = 0; i < r + m; ++i)
+                pilots[i] = 0;
+
+            // bucket sizes first, flagged as pending
+            std::uint32_t largest = 0;
+            for (std::size_t i = 0; i < n; ++i)
+                largest = std::max(largest, ++pilots[index_bucket(d.keys_[start + i], r)]);
+            if (largest > index_max_bucket)
+                return 0;
+            for (std::size_t b = 0; b < r; ++b)
+                if (pilots[b] != 0)
+                    pilots[b] |= index_pending;
+
+            std::array<std::uint32_t, index_max_bucket> members{};
+            std::array<std::uint32_t, index_max_bucket> taken{};
+            for (auto size = largest; size > 0; --size)
+                for (std::uint32_t b = 0; b < r; ++b)
+                {
+                    if (pilots[b] != (index_pending | size))
+                        continue;
+                    std::size_t k = 0;
+                    for (std::uint32_t i = 0; i < n; ++i)
+                        if (index_bucket(d.keys_[start + i], r) == b)
+                            members[k++] = i;
+
+                    std::uint32_t pilot = 0;
+                    for (; pilot < index_max_pilot; ++pilot)
+                    {
+                        bool fits = true;
+                        for (std::size_t j = 0; j < size && fits; ++j)
+                        {
+                            taken[j] = index_slot(d.keys_[start + members[j]], pilot, m);
+                            fits = slots[taken[j]] == 0;
+                            for (std::size_t q = 0; q < j && fits; ++q)
+                                fits = taken[q] != taken[j];
+                        }
+                        if (fits)
+                            break;
+                    }
+                    if (pilot == index_max_pilot)
+                        return 0;
+                    for (std::size_t j = 0; j < size; ++j)
+                        slots[taken[j]] = members[j] + 1;
+                    pilots[b] = pilot;
+                }
+
+            d.index_[o] = static_cast<std::uint32_t>(m);
+            d.index_[o + 1] = static_cast<std::uint32_t>(r);
+            d.index_size_ += 2 + r + m;
+            return static_cast<std::uint32_t>(o + 1);
+        }
+    };
+
+    // document — holds the root value, a flat pool of all container children
+    // (stored as parallel key and value columns, so lookups scan only keys and
+    // sequence iteration touches only values) and one shared character arena
+    // that owns the bytes of its keys and strings (see source_string() for
+    // when they reference the input instead). Arena keys are stored as
+    // offsets into `chars_` and arena strings in root_ and the pool as their
+    // distance from the node (see value), so a document has no pointers into
+    // itself: it can be a constexpr variable anywhere and copies as plain data.
+    // Keys are interned: the key column holds ids into `strings_`, so each
+    // distinct key is stored once and compared as an integer.
+    // Mappings with DATA_CT_INDEX_MIN_KEYS or more keys also get a perfect-hash
+    // index over their key ids in `index_`, so find() on them is one probe.
+    // NodeCount, CharCount and StringCount are the pool, arena and string table
+    // capacities; a document that is parsed into needs StringCount > NodeCount.
+    // IndexCount words of index fit any document of NodeCount nodes at the
+    // default; a mapping whose index does not fit falls back to a scan.
+    // With SortedKeys, mappings get no hash index; instead `order_` holds, for
+    // each mapping, its child offsets sorted by key id, which find() binary
+    // searches. Children stay in source order, so iteration is unaffected.
+    template <std::size_t NodeCount, std::size_t CharCount, std::size_t StringCount = NodeCount * 2 + 1,
+              std::size_t IndexCount = NodeCount * 3, bool SortedKeys = false>
+    struct basic_document : document_lookup<basic_document<NodeCount, CharCount, StringCount, IndexCount, SortedKeys>>
+    {
+        static constexpr std::size_t node_capacity = NodeCount;
+        static constexpr std::size_t char_capacity = CharCount;
+        static constexpr std::size_t string_capacity = StringCount;
+        static constexpr std::size_t index_capacity = IndexCount;
+        static constexpr bool sorted_keys = SortedKeys;
+
+        value root_{};
+        std::array<std::uint32_t, NodeCount> keys_{};
+        std::array<value, NodeCount> nodes_{};
+        std::size_t pool_size_{0};
+        std::size_t top_{NodeCount}; // staged children occupy [top_, NodeCount)
+        string_table<StringCount> strings_{};
+        std::array<char, CharCount> chars_{};
+        std::size_t chars_size_{0};
+        std::array<std::uint32_t, IndexCount> index_{};
+        std::size_t index_size_{0};
+        std::array<std::uint32_t, SortedKeys ? NodeCount : 0> order_{};
+
+        constexpr basic_document() noexcept = default;
+
+        // the parsed root, stored as the pool stores its nodes
+        constexpr auto set_root(value const &v) noexcept -> void { root_ = stored(v, &root_); }
+
+        constexpr auto alloc(std::size_t count) noexcept -> std::size_t
+        {
+            auto start = pool_size_;
+            pool_size_ += count;
+            return start;
+        }
+
+        [[nodiscard]] constexpr bool can_alloc(std::size_t count) const noexcept
+        {
+            return pool_size_ + count <= top_;
+        }
+
+        // append one child to the pool — caller checks can_alloc() first;
+        // sequence children keep the empty key (id 0). commit() leaves room in
+        // the string table for a key on every node still to be pushed or staged.
+        constexpr auto push(value const &v) noexcept -> void
+        {
+            nodes_[pool_size_] = stored(v, &nodes_[pool_size_]);
+            ++pool_size_;
+        }
+
+        constexpr auto push(pool_entry const &e) noexcept -> void
+        {
+            keys_[pool_size_] = strings_.intern(stored(e.key), chars_.data());
+            nodes_[pool_size_] = stored(e.val_, &nodes_[pool_size_]);
+            ++pool_size_;
+        }
+
+        // Children of a container being parsed are staged at the free end of
+        // the pool, growing down, while nested containers finish into the
+        // front. `mark` is top_ when the container opened; finish() moves its
+        // children, in order, to the front and returns where they start.
+
+        // stage one child — false when the pool is full
+        [[nodiscard]] constexpr auto stage(value const &v) noexcept -> bool
+        {
+            if (pool_size_ >= top_)
+                return false;
+            keys_[--top_] = 0;
+            nodes_[top_] = stored(v, &nodes_[top_]);
+            return true;
+        }
+
+        [[nodiscard]] constexpr auto stage(string_ref key, value const &v) noexcept -> bool
+        {
+            if (pool_size_ >= top_)
+                return false;
+            keys_[--top_] = strings_.intern(stored(key), chars_.data());
+            nodes_[top_] = stored(v, &nodes_[top_]);
+            return true;
+        }
+
+        // where a container opening now starts its staged children
+        [[nodiscard]] constexpr auto mark() const noexcept -> std::size_t { return top_; }
+
+        [[nodiscard]] constexpr auto staged(std::size_t mark) const noexcept -> std::size_t
+        {
+            return mark - top_;
+        }
+
+        // true if `key` is already staged since `mark` — always false with
+        // SortedKeys, where finish_mapping() finds duplicates by sorting
+        [[nodiscard]] constexpr auto is_staged(std::size_t mark, std::string_view key) const noexcept -> bool
+        {
+            if constexpr (SortedKeys)
+                return false;
+            auto const id = strings_.find(key, chars_.data());
+            if (id == strings_.npos)
+                return false;
+            for (std::size_t i = top_; i < mark; ++i)
+                if (keys_[i] == id)
+                    return true;
+            return false;
+        }
+
+        constexpr auto finish(std::size_t mark) noexcept -> std::size_t
+        {
+            auto const start = pool_size_;
+            auto const count = mark - top_;
+            if (start + count <= top_)
+            {
+                // staged in reverse — copy back in source order
+                for (std::size_t i = 0; i < count; ++i)
+                    relocate(mark - 1 - i, start + i);
+            }
+            else
+            {
+                // the pool has grown into the staged children
+                for (std::size_t i = top_, j = mark - 1; i < j; ++i, --j)
+                {
+                    auto const node = nodes_[i];
+                    std::swap(keys_[i], keys_[j]);
+                    nodes_[i] = moved(nodes_[j], j, i);
+                    nodes_[j] = moved(node, i, j);
+                }
+                for (std::size_t i = 0; i < count; ++i)
+                    relocate(top_ + i, start + i);
+            }
+            // clear vacated slots so a finished document holds no stale nodes
+            for (auto i = std::max(start + count, top_); i < mark; ++i)
+            {
+                keys_[i] = 0;
+                nodes_[i] = value{};
+            }
+            pool_size_ += count;
+            top_ = mark;
+            return start;
+        }
+
+        constexpr auto finish_sequence(std::size_t mark) noexcept -> value
+        {
+            auto const count = staged(mark);
+            return value::make_sequence(finish(mark), count);
+        }
+
+        // empty when two children share a key (only detected here with SortedKeys)
+        constexpr auto finish_mapping(std::size_t mark) noexcept -> std::optional<value>
+        {
+            auto const count = staged(mark);
+            return this->index_mapping(finish(mark), count);
+        }
+
+        [[nodiscard]] constexpr bool can_store(std::size_t count) const noexcept
+        {
+            return chars_size_ + count <= CharCount;
+        }
+
+        // append one character to the arena — caller checks can_store() first
+        constexpr auto append(char c) noexcept -> void { chars_[chars_size_++] = c; }
+
+        // append a run of characters at once
+        constexpr auto append(std::string_view run) noexcept -> void
+        {
+            std::ranges::copy(run, chars_.data() + chars_size_);
+            chars_size_ += run.size();
+        }
+
+        // finish the string appended to the arena since offset `start`. If the
+        // same bytes are already interned the copy is dropped and the interned
+        // string reused; otherwise it is interned so later copies dedupe too.
+        constexpr auto commit(std::size_t start) noexcept -> string_ref
+        {
+            string_ref s{chars_.data() + start, static_cast<std::uint32_t>(chars_size_ - start), true};
+            auto const hash = hash_string(s.view());
+            auto id = strings_.find(s.view(), hash, chars_.data());
+            if (id != strings_.npos)
+            {
+                chars_size_ = start;
+                return loaded(strings_[id]);
+            }
+            if (strings_.size_ + (top_ - pool_size_) < StringCount)
+                strings_.intern(stored(s), hash, chars_.data());
+            return s;
+        }
+
+        // same nodes, strings and indexes in tables of `Nodes`, `Strings` and
+        // `Index` entries (at least pool_size_, strings_.size_ and index_size_)
+        // with arena strings pointing into `arena`, a copy of chars_ with static
+        // storage that outlives the result — the result owns no arena of its
+        // own, so copies of it carry no self-references
+        template <std::size_t Nodes, std::size_t Strings, std::size_t Index>
+        [[nodiscard]] constexpr auto detach(char const *arena) const noexcept
+            -> basic_document<Nodes, 0, Strings, Index, SortedKeys>
+        {
+            basic_document<Nodes, 0, Strings, Index, SortedKeys> out{};
+            out.root_ = detached(&root_, arena);
+            out.pool_size_ = pool_size_;
+            for (std::size_t i = 0; i < pool_size_; ++i)
+            {
+                out.keys_[i] = keys_[i];
+                out.nodes_[i] = detached(&nodes_[i], arena);
+            }
+            // re-interning in id order keeps every id
+            for (std::size_t i = 1; i < strings_.size_; ++i)
+                out.strings_.intern(source_ref(stored_view(strings_.strings_[i], arena)), nullptr);
+            out.index_size_ = index_size_;
+            for (std::size_t i = 0; i < index_size_; ++i)
+                out.index_[i] = index_[i];
+            if constexpr (SortedKeys)
+                for (std::size_t i = 0; i < pool_size_; ++i)
+                    out.order_[i] = order_[i];
+            return out;
+        }
+
+    private:
+        friend document_lookup<basic_document>;
+
+        [[nodiscard]] constexpr auto reserve_index(std::size_t words) const noexcept -> bool
+        {
+            return words <= IndexCount;
+        }
+
+        [[nodiscard]] constexpr auto arena() const noexcept -> char const * { return chars_.data(); }
+
+        [[nodiscard]] constexpr auto key_id(std::string_view key, std::uint32_t hash) const noexcept -> std::uint32_t
+        {
+            return strings_.find(key, hash, chars_.data());
+        }
+
+        // a string the parser handed over, as the document keeps it
+        constexpr auto stored(string_ref s) const noexcept -> string_ref
+        {
+            if (!s.in_arena_)
+                return s;
+            string_ref r{};
+            r.offset_ = static_cast<std::size_t>(s.data_ - chars_.data());
+            r.size_ = s.size_;
+            r.in_arena_ = true;
+            return r;
+        }
+
+        // `v` as the document keeps it at `node`, root_ or a pool node
+        constexpr auto stored(value const &v, value const *node) const noexcept -> value
+        {
+            if (v.kind_ != value::kind::string || !v.in_arena_)
+                return v;
+            return value::make_stored_string(distance(node) + static_cast<std::size_t>(v.data_.str_ - chars_.data()),
+                                             v.size_);
         }
+
+        // bytes from `node` to the start of chars_, computed from the layout
+        // so a constant expression can use it
+        constexpr auto distance(value const *node) const noexcept -> std::size_t
+        {
+            if (node == &root_)
+                return offsetof(basic_document, chars_) - offsetof(basic_document, root_);
+            return offsetof(basic_document, chars_) - offsetof(basic_document, nodes_) -
+                   static_cast<std::size_t>(node - nodes_.data()) * sizeof(value);
+        }
+
+        // the bytes of stored string `node`
+        constexpr auto stored_string(value const &node) const noexcept -> std::string_view
+        {
+            if (!node.relative_)
+                return node.as_string();
+            return {chars_.data() + (node.data_.offset_ - distance(&node)), node.size_};
+        }
+
+        // stored node `node` with its string pointing into `arena` instead
+        constexpr auto detached(value const *node, char const *arena) const noexcept -> value
+        {
+            if (!node->relative_)
+                return *node;
+            return value::make_string(source_ref({arena + (node->data_.offset_ - distance(node)), node->size_}));
+        }
+
+        // a pool node moved from slot `from` to slot `to`
+        static constexpr auto moved(value v, std::size_t from, std::size_t to) noexcept -> value
+        {
+            if (v.relative_)
+                v.data_.offset_ += (from - to) * sizeof(value);
+            return v;
+        }
+
+        constexpr auto relocate(std::size_t from, std::size_t to) noexcept -> void
+        {
+            keys_[to] = keys_[from];
+            nodes_[to] = moved(nodes_[from], from, to);
+        }
+
+        // a stored string as the parser sees it
+        constexpr auto loaded(string_ref s) const noexcept -> string_ref
+        {
+            if (!s.in_arena_)
+                return s;
+            return {chars_.data() + s.offset_, s.size_, true};
+        }
+    };
+
+    // document sized by the DATA_CT_MAX_* limits
+    using document = basic_document<DATA_CT_MAX_NODES, DATA_CT_MAX_CHARS>;
+
+    // the same limits with the layout `Opts` selects
+    template <data::options Opts>
+    using options_document = basic_document<DATA_CT_MAX_NODES, DATA_CT_MAX_CHARS, DATA_CT_MAX_NODES * 2 + 1,
+                                             Opts.sorted_keys ? 0 : DATA_CT_MAX_NODES * 3, Opts.sorted_keys>;
+
+    // a document that streams parse events instead of keeping nodes
+    template <typename Document>
+    concept event_sink = requires(Document &doc, string_ref key, std::size_t mark) {
+        doc.open(value::kind::null);
+        doc.announce(key);
+        doc.drop(mark);
     };
 
+    // Parse-order hooks the parsers call. A document that keeps nodes needs
+    // only its mark(); an event_sink also hears when a container opens (kind
+    // null: an XML element not yet known to be a mapping), which key the
+    // next value belongs to, and when an opened element turned out to be a
+    // scalar.
+    template <typename Document>
+    constexpr auto open_container(Document &doc, value::kind kind) noexcept -> std::size_t
+    {
+        if constexpr (event_sink<Document>)
+            return doc.open(kind);
+        else
+            return doc.mark();
+    }
+
+    template <typename Document>
+    constexpr auto announce_key(Document &doc, string_ref key) noexcept -> void
+    {
+        if constexpr (event_sink<Document>)
+            doc.announce(key);
+    }
+
+    template <typename Document>
+    constexpr auto drop_container(Document &doc, std::size_t mark) noexcept -> void
+    {
+        if constexpr (event_sink<Document>)
+            doc.drop(mark);
+    }
+
+    // A key or string taken verbatim from the input. It is copied into the
+    // document's arena, so the document owns it and the input may go away —
+    // except with Opts.reference_source, during constant evaluation, where
+    // the input can only be static (a constant that points at anything
+    // shorter-lived does not compile), and for an event_sink, whose strings
+    // only last the call that delivers them. Empty when the arena is full.
+    template <data::options Opts, typename Document>
+    constexpr auto source_string(Document &doc, std::string_view text) noexcept -> std::optional<string_ref>
+    {
+        if consteval
+        {
+            return source_ref(text);
+        }
+        if (Opts.reference_source || event_sink<Document> || text.empty())
+            return source_ref(text);
+        if (!doc.can_store(text.size()))
+            return std::nullopt;
+        auto const start = doc.chars_size_;
+        doc.append(text);
+        return doc.commit(start);
+    }
+
 } // namespace data::detail
@@ -1,26 +1,62 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
 namespace data::detail
 {
-    constexpr bool is_alpha(char c) noexcept
+    // character classes, bit flags of char_classes[]
+    namespace char_class
     {
-        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-    }
+        inline constexpr std::uint8_t digit = 1 << 0;      // 0-9
+        inline constexpr std::uint8_t hex = 1 << 1;        // 0-9 a-f A-F
+        inline constexpr std::uint8_t alpha = 1 << 2;      // a-z A-Z
+        inline constexpr std::uint8_t identifier = 1 << 3; // alnum '_' '-': YAML words and anchors
+        inline constexpr std::uint8_t bare_key = identifier; // TOML bare keys allow the same set
+        inline constexpr std::uint8_t xml_name = 1 << 4;   // identifier '.' ':'
+        inline constexpr std::uint8_t blank = 1 << 5;      // ' ' '\t' — TOML whitespace
+        inline constexpr std::uint8_t yaml_space = 1 << 6; // blank '\n'
+        inline constexpr std::uint8_t whitespace = 1 << 7; // blank '\n' '\r' — JSON and XML
+    } // namespace char_class
 
-    constexpr bool is_digit(char c) noexcept
+    // classes of every byte; bytes >= 0x80 have none
+    inline constexpr auto char_classes = []
     {
-        return c >= '0' && c <= '9';
-    }
+        std::array<std::uint8_t, 256> t{};
+        for (unsigned c = 0; c < 128; ++c)
+        {
+            bool const digit = c >= '0' && c <= '9';
+            bool const alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            bool const identifier = digit || alpha || c == '_' || c == '-';
+            bool const blank = c == ' ' || c == '\t';
+            t[c] = static_cast<std::uint8_t>(
+                (digit ? char_class::digit : 0) |
+                (digit || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F') ? char_class::hex : 0) |
+                (alpha ? char_class::alpha : 0) |
+                (identifier ? char_class::identifier : 0) |
+                (identifier || c == '.' || c == ':' ? char_class::xml_name : 0) |
+                (blank ? char_class::blank : 0) |
+                (blank || c == '\n' ? char_class::yaml_space : 0) |
+                (blank || c == '\n' || c == '\r' ? char_class::whitespace : 0));
+        }
+        return t;
+    }();
 
-    constexpr bool is_alnum(char c) noexcept
+    // one load and mask: whether `c` is in any of `classes`
+    constexpr bool is_class(char c, std::uint8_t classes) noexcept
     {
-        return is_alpha(c) || is_digit(c);
+        return (char_classes[static_cast<unsigned char>(c)] & classes) != 0;
     }
 
-    constexpr bool is_hex(char c) noexcept
-    {
-        return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
-    }
+    constexpr bool is_alpha(char c) noexcept { return is_class(c, char_class::alpha); }
+    // one range, so one compare beats the load
+    constexpr bool is_digit(char c) noexcept { return static_cast<unsigned char>(c - '0') < 10; }
+    constexpr bool is_alnum(char c) noexcept { return is_class(c, char_class::alpha | char_class::digit); }
+    constexpr bool is_hex(char c) noexcept { return is_class(c, char_class::hex); }
 
     constexpr unsigned hex_value(char c) noexcept
     {
@@ -30,4 +66,62 @@ namespace data::detail
         return 0;
     }
 
+    // eight bytes at s[i] as a little-endian word, the same in constant
+    // evaluation (byte by byte) and at runtime (one load)
+    constexpr std::uint64_t load_le64(std::string_view s, std::size_t i) noexcept
+    {
+        if !consteval
+        {
+            std::uint64_t w;
+            std::memcpy(&w, s.data() + i, 8);
+            if constexpr (std::endian::native == std::endian::big)
+                w = std::byteswap(w);
+            return w;
+        }
+        std::uint64_t w = 0;
+        for (std::size_t k = 0; k < 8; ++k)
+            w |= std::uint64_t{static_cast<unsigned char>(s[i + k])} << (8 * k);
+        return w;
+    }
+
+    // 32-bit string hash, a multiply per eight bytes (FxHash-style) and a
+    // murmur3 finalizer so the low bits used for table slots are mixed
+    constexpr std::uint32_t hash_string(std::string_view s) noexcept
+    {
+        constexpr std::uint64_t k = 0x517cc1b727220a95;
+        std::uint64_t h = s.size() * k;
+        std::size_t i = 0;
+        for (; i + 8 <= s.size(); i += 8)
+            h = (std::rotl(h, 5) ^ load_le64(s, i)) * k;
+        if (i < s.size())
+        {
+            // the last eight bytes, overlapping the previous word; shorter
+            // strings are assembled byte by byte
+            std::uint64_t tail = 0;
+            if (s.size() >= 8)
+                tail = load_le64(s, s.size() - 8);
+            else
+                for (std::size_t j = 0; j < s.size(); ++j)
+                    tail |= std::uint64_t{static_cast<unsigned char>(s[j])} << (8 * j);
+            h = (std::rotl(h, 5) ^ tail) * k;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccd;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53;
+        h ^= h >> 33;
+        return static_cast<std::uint32_t>(h);
+    }
+
+    // 32-bit integer finalizer (lowbias32) — spreads small sequential ids
+    constexpr std::uint32_t mix_hash(std::uint32_t x) noexcept
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
 } // namespace data::detail
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <immutable_data/detail/number.hpp>
 #include <immutable_data/detail/types.hpp>
 #include <immutable_data/detail/utils.hpp>
+#include <algorithm>
 #include <array>
+#include <optional>
 #include <string_view>
+#include <utility>
 #include <variant>
 
 namespace data::xml::detail
@@ -11,13 +15,14 @@ namespace data::xml::detail
 
     using namespace data::detail;
 
+    template <typename Document = document, data::options Opts = {}>
     class parser
     {
     public:
-        constexpr explicit parser(std::string_view input, document &doc) noexcept
+        constexpr explicit parser(std::string_view input, Document &doc) noexcept
             : input_{input}, doc_{doc} {}
 
-        constexpr auto parse_document() noexcept -> std::variant<document, data::parse_error>
+        constexpr auto parse_document() noexcept -> std::variant<Document, data::parse_error>
         {
             skip_whitespace();
             skip_prolog();
@@ -26,8 +31,8 @@ namespace data::xml::detail
             if (std::holds_alternative<data::parse_error>(result))
                 return std::get<data::parse_error>(result);
 
-            doc_.root_ = std::get<pool_entry>(result).val_;
-            return doc_;
+            doc_.set_root(std::get<pool_entry>(result).val_);
+            return std::move(doc_);
         }
 
     private:
@@ -51,6 +56,26 @@ namespace data::xml::detail
             return {ec, line_, col_};
         }
 
+        // close the element's mapping opened at `mark`; duplicate keys that
+        // were not caught while staging (sorted-key documents) surface here
+        constexpr auto finish_mapping(std::string_view tag_name, std::size_t mark) noexcept
+            -> std::variant<pool_entry, data::parse_error>
+        {
+            if (auto mapping = doc_.finish_mapping(mark))
+                return make_entry(tag_name, *mapping);
+            return make_error(data::error_code::duplicate_key);
+        }
+
+        // an element's entry in its parent, keyed by its tag name
+        constexpr auto make_entry(std::string_view tag_name, value const &v) noexcept
+            -> std::variant<pool_entry, data::parse_error>
+        {
+            auto const key = source_string<Opts>(doc_, tag_name);
+            if (!key)
+                return make_error(data::error_code::string_overflow);
+            return pool_entry{*key, v};
+        }
+
         struct depth_guard
         {
             std::size_t &depth_;
@@ -60,7 +85,7 @@ namespace data::xml::detail
 
         constexpr void skip_whitespace() noexcept
         {
-            while (!at_end() && (peek() == ' ' || peek() == '\t' || peek() == '\n' || peek() == '\r'))
+            while (!at_end() && is_class(peek(), char_class::whitespace))
                 advance();
         }
 
@@ -99,16 +124,15 @@ namespace data::xml::detail
             }
         }
 
-        constexpr auto read_name() noexcept -> string_type
+        constexpr auto read_name() noexcept -> std::string_view
         {
-            string_type name{};
-            while (!at_end() && (is_alnum(peek()) || peek() == '_' || peek() == '-' ||
-                                 peek() == '.' || peek() == ':'))
-                name.push_back(advance());
-            return name;
+            auto start = pos_;
+            while (!at_end() && is_class(peek(), char_class::xml_name))
+                advance();
+            return input_.substr(start, pos_ - start);
         }
 
-        constexpr auto parse_attr_value() noexcept -> std::variant<string_type, data::parse_error>
+        constexpr auto parse_attr_value() noexcept -> std::variant<string_ref, data::parse_error>
         {
             skip_whitespace();
             if (at_end() || peek() != '=')
@@ -121,30 +145,64 @@ namespace data::xml::detail
                 return make_error(data::error_code::unexpected_token);
             advance(); // skip opening quote
 
-            string_type val{};
+            auto start = pos_;
             while (!at_end() && peek() != quote)
-                val.push_back(advance());
+                advance();
 
             if (at_end())
                 return make_error(data::error_code::unterminated_string);
+            auto val = input_.substr(start, pos_ - start);
             advance(); // skip closing quote
-            return val;
+            return source_ref(val);
         }
 
         static constexpr auto trim_view(std::string_view sv) noexcept -> std::string_view
         {
-            while (!sv.empty() && (sv.front() == ' ' || sv.front() == '\t' ||
-                                   sv.front() == '\n' || sv.front() == '\r'))
+            while (!sv.empty() && is_class(sv.front(), char_class::whitespace))
                 sv.remove_prefix(1);
-            while (!sv.empty() && (sv.back() == ' ' || sv.back() == '\t' ||
-                                   sv.back() == '\n' || sv.back() == '\r'))
+            while (!sv.empty() && is_class(sv.back(), char_class::whitespace))
                 sv.remove_suffix(1);
             return sv;
         }
 
-        constexpr auto detect_scalar(std::string_view sv) noexcept -> value
+        // calls `fn` on each run of character data in `content` — element
+        // content of text, comments and CDATA sections only — skipping what
+        // parse_element() skips: comments with the whitespace after them, and
+        // CDATA delimiters
+        template <typename Fn>
+        static constexpr auto for_each_text(std::string_view content, Fn fn) noexcept -> void
+        {
+            constexpr auto npos = std::string_view::npos;
+            std::size_t i = 0;
+            while (i < content.size())
+            {
+                if (content.substr(i, 4) == "<!--")
+                {
+                    auto const end = content.find("-->", i + 4);
+                    i = end == npos ? content.size() : end + 3;
+                    while (i < content.size() && is_class(content[i], char_class::whitespace))
+                        ++i;
+                }
+                else if (content.substr(i, 3) == "<![")
+                {
+                    auto const body = std::min(i + 9, content.size());
+                    auto const end = content.find("]]>", body);
+                    fn(content.substr(body, end - body));
+                    i = end == npos ? content.size() : end + 3;
+                }
+                else
+                {
+                    auto const end = content.find('<', i);
+                    fn(content.substr(i, end - i));
+                    i = end == npos ? content.size() : end;
+                }
+            }
+        }
+
+        constexpr auto detect_scalar(string_ref ref) noexcept -> value
         {
-            if (sv.empty()) return value::make_string(string_type{});
+            auto sv = ref.view();
+            if (sv.empty()) return value::make_string(string_ref{});
             if (sv == "true") return value::make_bool(true);
             if (sv == "false") return value::make_bool(false);
             if (sv == "null") return value::make_null();
@@ -152,10 +210,9 @@ namespace data::xml::detail
             // Try number
             bool valid = true;
             bool has_dot = false;
-            bool negative = false;
             std::size_t start = 0;
 
-            if (sv[0] == '-') { negative = true; start = 1; }
+            if (sv[0] == '-') { start = 1; }
             else if (sv[0] == '+') { start = 1; }
 
             if (start >= sv.size() || !is_digit(sv[start]))
@@ -177,30 +234,34 @@ namespace data::xml::detail
 
             if (valid && has_dot)
             {
-                floating result = 0.0;
-                floating decimal_place = 0.1;
-                bool in_decimal = false;
-                for (std::size_t i = start; i < sv.size(); ++i)
-                {
-                    if (is_digit(sv[i]))
-                    {
-                        if (in_decimal) { result += (sv[i] - '0') * decimal_place; decimal_place *= 0.1; }
-                        else result = result * 10.0 + (sv[i] - '0');
-                    }
-                    else if (sv[i] == '.') in_decimal = true;
-                }
-                return value::make_float(negative ? -result : result);
+                // the scan above leaves only digits and one '.'
+                return value::make_float(*data::detail::parse_float(sv));
             }
 
             if (valid)
             {
-                integer result = 0;
-                for (std::size_t i = start; i < sv.size(); ++i)
-                    result = result * 10 + (sv[i] - '0');
-                return value::make_int(negative ? -result : result);
+                // text past int64 stays text unless the options ask for a double
+                auto const n = data::detail::parse_integer(sv);
+                if (n.status == integer_status::ok)
+                    return value::make_int(n.value);
+                if constexpr (Opts.overflow_to_float)
+                    return value::make_float(*data::detail::parse_float(sv));
             }
 
-            return value::make_string(string_type{sv});
+            return value::make_string(ref);
+        }
+
+        // text or an attribute value as a scalar; one that stays a string is
+        // kept as source_string() keeps it. Empty when the arena is full.
+        constexpr auto make_scalar(string_ref ref) noexcept -> std::optional<value>
+        {
+            auto const v = detect_scalar(ref);
+            if (!v.is_string() || ref.in_arena_)
+                return v;
+            auto const kept = source_string<Opts>(doc_, ref.view());
+            if (!kept)
+                return std::nullopt;
+            return value::make_string(*kept);
         }
 
         constexpr auto parse_element() noexcept -> std::variant<pool_entry, data::parse_error>
@@ -217,27 +278,29 @@ namespace data::xml::detail
             advance(); // skip <
 
             auto tag_name = read_name();
-            if (tag_name.view().empty())
+            if (tag_name.empty())
                 return make_error(data::error_code::unexpected_token);
+            announce_key(doc_, source_ref(tag_name));
 
-            // Parse attributes
-            std::array<pool_entry, DATA_CT_MAX_ITEMS> attrs{};
-            std::size_t attr_count = 0;
+            // Parse attributes — staged ahead of any child elements
+            auto const mark = open_container(doc_, value::kind::null);
 
             skip_whitespace();
             while (!at_end() && peek() != '>' && peek() != '/')
             {
                 auto attr_name = read_name();
-                if (attr_name.view().empty()) break;
+                if (attr_name.empty()) break;
 
                 auto attr_val_result = parse_attr_value();
                 if (std::holds_alternative<data::parse_error>(attr_val_result))
                     return std::get<data::parse_error>(attr_val_result);
-                auto attr_val = std::get<string_type>(attr_val_result);
+                auto const attr_key = source_string<Opts>(doc_, attr_name);
+                auto const attr_val = make_scalar(std::get<string_ref>(attr_val_result));
+                if (!attr_key || !attr_val)
+                    return make_error(data::error_code::string_overflow);
 
-                if (attr_count >= DATA_CT_MAX_ITEMS)
-                    return make_error(data::error_code::invalid_syntax);
-                attrs[attr_count++] = pool_entry{attr_name, detect_scalar(attr_val.view())};
+                if (!doc_.stage(*attr_key, *attr_val))
+                    return make_error(data::error_code::pool_overflow);
                 skip_whitespace();
             }
 
@@ -249,15 +312,12 @@ namespace data::xml::detail
                     return make_error(data::error_code::unexpected_token);
                 advance(); // skip >
 
-                if (attr_count == 0)
-                    return pool_entry{tag_name, value::make_null()};
-
-                if (!doc_.can_alloc(attr_count))
-                    return make_error(data::error_code::pool_overflow);
-                auto start = doc_.pool_size_;
-                for (std::size_t i = 0; i < attr_count; ++i)
-                    doc_.pool_[doc_.pool_size_++] = attrs[i];
-                return pool_entry{tag_name, value::make_mapping(start, attr_count)};
+                if (doc_.staged(mark) == 0)
+                {
+                    drop_container(doc_, mark);
+                    return make_entry(tag_name, value::make_null());
+                }
+                return finish_mapping(tag_name, mark);
             }
 
             if (at_end() || peek() != '>')
@@ -265,13 +325,16 @@ namespace data::xml::detail
             advance(); // skip >
 
             // Parse content: text, child elements, comments
-            std::array<pool_entry, DATA_CT_MAX_ITEMS> children{};
-            std::size_t child_count = attr_count;
-            // Start with attributes
-            for (std::size_t i = 0; i < attr_count; ++i)
-                children[i] = attrs[i];
+            auto const attr_count = doc_.staged(mark);
 
-            string_type text_buf{};
+            // Text is taken as a slice of the input while it is one contiguous
+            // run; comments or CDATA sections split it, and only then is it
+            // joined in the arena, once the element turns out to hold text
+            auto const content_start = pos_;
+            bool has_text = false;
+            std::size_t text_start = 0;
+            std::size_t text_end = 0;
+            bool text_split = false;
 
             while (!at_end())
             {
@@ -292,9 +355,11 @@ namespace data::xml::detail
                     if (peek_at(1) == '!' && peek_at(2) == '[')
                     {
                         // Skip <![CDATA[
+                        has_text = true;
+                        text_split = true;
                         for (int i = 0; i < 9; ++i) advance();
                         while (!at_end() && !(peek() == ']' && peek_at(1) == ']' && peek_at(2) == '>'))
-                            text_buf.push_back(advance());
+                            advance();
                         if (!at_end()) { advance(); advance(); advance(); } // skip ]]>
                         continue;
                     }
@@ -307,22 +372,32 @@ namespace data::xml::detail
                     auto &child = std::get<pool_entry>(child_result);
 
                     // Duplicate key check
-                    for (std::size_t j = 0; j < child_count; ++j)
-                        if (children[j].key.view() == child.key.view())
-                            return make_error(data::error_code::duplicate_key);
+                    if (doc_.is_staged(mark, child.key.view()))
+                        return make_error(data::error_code::duplicate_key);
 
-                    if (child_count >= DATA_CT_MAX_ITEMS)
-                        return make_error(data::error_code::invalid_syntax);
-                    children[child_count++] = child;
+                    if (!doc_.stage(child.key, child.val_))
+                        return make_error(data::error_code::pool_overflow);
                 }
                 else
                 {
                     // Text content
+                    if (!has_text)
+                    {
+                        has_text = true;
+                        text_start = pos_;
+                    }
+                    else if (pos_ != text_end)
+                    {
+                        text_split = true;
+                    }
                     while (!at_end() && peek() != '<')
-                        text_buf.push_back(advance());
+                        advance();
+                    text_end = pos_;
                 }
             }
 
+            auto const content = input_.substr(content_start, pos_ - content_start);
+
             // Parse closing tag </name>
             if (at_end() || peek() != '<')
                 return make_error(data::error_code::unexpected_token);
@@ -332,7 +407,7 @@ namespace data::xml::detail
             advance(); // /
 
             auto close_name = read_name();
-            if (close_name.view() != tag_name.view())
+            if (close_name != tag_name)
                 return make_error(data::error_code::unexpected_token);
 
             skip_whitespace();
@@ -341,43 +416,77 @@ namespace data::xml::detail
             advance(); // >
 
             // Determine result type
-            if (child_count > attr_count)
+            // Has child elements (possibly with attributes) → mapping
+            if (doc_.staged(mark) > attr_count)
+                return finish_mapping(tag_name, mark);
+
+            string_ref text{};
+            if (!text_split)
             {
-                // Has child elements (possibly with attributes) → mapping
-                if (!doc_.can_alloc(child_count))
-                    return make_error(data::error_code::pool_overflow);
-                auto start = doc_.pool_size_;
-                for (std::size_t i = 0; i < child_count; ++i)
-                    doc_.pool_[doc_.pool_size_++] = children[i];
-                return pool_entry{tag_name, value::make_mapping(start, child_count)};
+                auto whole = input_.substr(text_start, text_end - text_start);
+                text = source_ref(trim_view(whole));
+            }
+            else
+            {
+                // the trimmed extent of the joined runs first, then copy just that
+                std::size_t length = 0;
+                std::size_t first = std::string_view::npos;
+                std::size_t last = 0;
+                for_each_text(content, [&](std::string_view run)
+                {
+                    for (auto c : run)
+                    {
+                        if (!is_class(c, char_class::whitespace))
+                        {
+                            first = std::min(first, length);
+                            last = length + 1;
+                        }
+                        ++length;
+                    }
+                });
+                if (first != std::string_view::npos)
+                {
+                    if (!doc_.can_store(last - first))
+                        return make_error(data::error_code::string_overflow);
+                    auto const start = doc_.chars_size_;
+                    std::size_t at = 0;
+                    for_each_text(content, [&](std::string_view run)
+                    {
+                        auto const lo = std::max(at, first);
+                        auto const hi = std::min(at + run.size(), last);
+                        if (lo < hi)
+                            doc_.append(run.substr(lo - at, hi - lo));
+                        at += run.size();
+                    });
+                    text = doc_.commit(start);
+                }
             }
-
-            auto trimmed = trim_view(text_buf.view());
 
             if (attr_count > 0)
             {
                 // Attributes + text → mapping with attrs, text is ignored if empty
-                if (!trimmed.empty())
+                if (text.size_ != 0)
                 {
                     // Store text under "_text" key
-                    if (child_count >= DATA_CT_MAX_ITEMS)
-                        return make_error(data::error_code::invalid_syntax);
-                    children[child_count++] = pool_entry{string_type{"_text"}, detect_scalar(trimmed)};
+                    auto const text_val = make_scalar(text);
+                    if (!text_val)
+                        return make_error(data::error_code::string_overflow);
+                    if (!doc_.stage(source_ref("_text"), *text_val))
+                        return make_error(data::error_code::pool_overflow);
                 }
-                if (!doc_.can_alloc(child_count))
-                    return make_error(data::error_code::pool_overflow);
-                auto start = doc_.pool_size_;
-                for (std::size_t i = 0; i < child_count; ++i)
-                    doc_.pool_[doc_.pool_size_++] = children[i];
-                return pool_entry{tag_name, value::make_mapping(start, child_count)};
+                return finish_mapping(tag_name, mark);
             }
 
             // Text only → auto-detect scalar
-            return pool_entry{tag_name, detect_scalar(trimmed)};
+            drop_container(doc_, mark);
+            auto const text_val = make_scalar(text);
+            if (!text_val)
+                return make_error(data::error_code::string_overflow);
+            return make_entry(tag_name, *text_val);
         }
 
         std::string_view input_;
-        document &doc_;
+        Document &doc_;
         std::size_t pos_{0};
         std::size_t line_{1};
         std::size_t col_{1};
@@ -1,9 +1,9 @@
 #pragma once
 
-// Compile-time YAML lexer — tokenizes YAML input into a fixed-size token array
+// Compile-time YAML lexer — produces tokens on demand for the parser
 
+#include <immutable_data/detail/simd.hpp>
 #include <immutable_data/detail/types.hpp>
-#include <array>
 #include <string_view>
 #include <variant>
 
@@ -12,43 +12,35 @@ namespace data::yaml::detail
 
     using namespace data::detail;
 
-    template <std::size_t MaxTokens = 1024>
     class lexer
     {
     public:
         struct state
         {
             std::size_t position{0};
-            std::size_t line{1};
-            std::size_t column{1};
         };
 
-        constexpr lexer() noexcept = default;
+        constexpr explicit lexer(std::string_view input) noexcept : input_{input} {}
 
-        constexpr auto tokenize(std::string_view input) noexcept -> std::variant<token_array<MaxTokens>, data::parse_error>
-        {
-            token_array<MaxTokens> tokens{};
-            std::size_t token_count = 0;
-            state s{};
-
-            while (!at_end(input, s) && token_count < MaxTokens)
-            {
-                skip_whitespace_and_comments(input, s);
-
-                if (at_end(input, s))
-                    break;
+        // lex `input` from `position` on, a token boundary found earlier
+        constexpr lexer(std::string_view input, std::size_t position) noexcept : input_{input}, s_{position} {}
 
-                auto token_result = next_token(input, s);
-                if (std::holds_alternative<data::parse_error>(token_result))
-                    return std::get<data::parse_error>(token_result);
+        [[nodiscard]] constexpr auto input() const noexcept -> std::string_view { return input_; }
 
-                tokens[token_count++] = std::get<token>(token_result);
-            }
-
-            if (token_count < MaxTokens)
-                tokens[token_count] = token{token_type::eof, {}, s.line, s.column};
-
-            return tokens;
+        // the next token, or eof once the input is consumed — the parser pulls
+        // tokens one at a time, so nothing is buffered
+        constexpr auto next() noexcept -> std::variant<token, data::parse_error>
+        {
+            skip_whitespace_and_comments(input_, s_);
+            if (at_end(input_, s_))
+                return token{token_type::eof, s_.position, 0};
+            auto const start = s_.position;
+            auto r = next_token(input_, s_);
+            // a token records a 32-bit offset and a 24-bit length
+            if (std::holds_alternative<token>(r) &&
+                (s_.position > token::max_offset || s_.position - start > token::max_length))
+                return error_at(input_, start, data::error_code::string_overflow);
+            return r;
         }
 
     private:
@@ -71,32 +63,61 @@ namespace data::yaml::detail
         {
             if (at_end(input, s))
                 return '\0';
-            char c = input[s.position++];
-            if (c == '\n')
+            return input[s.position++];
+        }
+
+        // spaces starting at `pos`
+        static constexpr auto count_spaces(std::string_view input, std::size_t pos) noexcept -> std::size_t
+        {
+            if !consteval
             {
-                ++s.line;
-                s.column = 1;
+                return skip_spaces(input, pos) - pos;
             }
-            else
+            std::size_t n = 0;
+            while (pos + n < input.size() && input[pos + n] == ' ')
+                ++n;
+            return n;
+        }
+
+        // the '\n' ending the line that holds `pos`, or the input end
+        static constexpr auto line_end(std::string_view input, std::size_t pos) noexcept -> std::size_t
+        {
+            if !consteval
             {
-                ++s.column;
+                return find_newline(input, pos);
             }
-            return c;
+            while (pos < input.size() && input[pos] != '\n')
+                ++pos;
+            return pos;
         }
 
         static constexpr auto skip_whitespace_and_comments(std::string_view input, state &s) noexcept -> void
         {
+            if !consteval
+            {
+                // tokens usually abut: settle that without a scan
+                if (at_end(input, s))
+                    return;
+                if (char const c = peek(input, s); !is_class(c, char_class::yaml_space) && c != '#')
+                    return;
+                while (true)
+                {
+                    s.position = skip_yaml_space(input, s.position);
+                    if (at_end(input, s) || peek(input, s) != '#')
+                        return;
+                    s.position = find_newline(input, s.position);
+                }
+            }
             while (!at_end(input, s))
             {
                 char c = peek(input, s);
-                if (c == ' ' || c == '\t' || c == '\n')
+                if (is_class(c, char_class::yaml_space))
                 {
                     advance(input, s);
                 }
                 else if (c == '#')
                 {
-                    while (!at_end(input, s) && peek(input, s) != '\n')
-                        advance(input, s);
+                    s.position = line_end(input, s.position);
                 }
                 else
                 {
@@ -108,14 +129,13 @@ namespace data::yaml::detail
         static constexpr auto next_token(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
             char c = peek(input, s);
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
+            std::size_t start_pos = s.position;
 
             switch (c)
             {
             case '\n':
                 advance(input, s);
-                return token{token_type::newline, "\n", start_line, start_column};
+                return token{token_type::newline, start_pos, 1};
 
             case '-':
                 if (peek_next(input, s) == '-' && s.position + 2 < input.size() && input[s.position + 2] == '-')
@@ -123,12 +143,12 @@ namespace data::yaml::detail
                     advance(input, s);
                     advance(input, s);
                     advance(input, s);
-                    return token{token_type::document_start, "---", start_line, start_column};
+                    return token{token_type::document_start, start_pos, 3};
                 }
-                else if (peek_next(input, s) == ' ' || peek_next(input, s) == '\t' || peek_next(input, s) == '\n')
+                else if (is_class(peek_next(input, s), char_class::yaml_space))
                 {
                     advance(input, s);
-                    return token{token_type::sequence_entry, "-", start_line, start_column};
+                    return token{token_type::sequence_entry, start_pos, 1};
                 }
                 else if (is_digit(peek_next(input, s)))
                 {
@@ -142,33 +162,33 @@ namespace data::yaml::detail
                     advance(input, s);
                     advance(input, s);
                     advance(input, s);
-                    return token{token_type::document_end, "...", start_line, start_column};
+                    return token{token_type::document_end, start_pos, 3};
                 }
                 break;
 
             case ':':
                 advance(input, s);
-                return token{token_type::mapping_key, ":", start_line, start_column};
+                return token{token_type::mapping_key, start_pos, 1};
 
             case '[':
                 advance(input, s);
-                return token{token_type::sequence_start, "[", start_line, start_column};
+                return token{token_type::sequence_start, start_pos, 1};
 
             case ']':
                 advance(input, s);
-                return token{token_type::sequence_end, "]", start_line, start_column};
+                return token{token_type::sequence_end, start_pos, 1};
 
             case '{':
                 advance(input, s);
-                return token{token_type::mapping_start, "{", start_line, start_column};
+                return token{token_type::mapping_start, start_pos, 1};
 
             case '}':
                 advance(input, s);
-                return token{token_type::mapping_end, "}", start_line, start_column};
+                return token{token_type::mapping_end, start_pos, 1};
 
             case ',':
                 advance(input, s);
-                return token{token_type::comma, ",", start_line, start_column};
+                return token{token_type::comma, start_pos, 1};
 
             case '"':
                 return parse_quoted_string(input, s, '"');
@@ -194,18 +214,16 @@ namespace data::yaml::detail
             default:
                 if (is_digit(c) || c == '-' || c == '+')
                     return parse_number(input, s);
-                else if (is_alpha(c) || c == '_')
+                else if (is_class(c, char_class::identifier)) // digits and '-' went to parse_number
                     return parse_identifier(input, s);
                 break;
             }
 
-            return data::parse_error{data::error_code::unexpected_token, s.line, s.column};
+            return error_at(input, s.position, data::error_code::unexpected_token);
         }
 
         static constexpr auto parse_quoted_string(std::string_view input, state &s, char quote) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             advance(input, s);
@@ -224,22 +242,29 @@ namespace data::yaml::detail
             }
 
             if (at_end(input, s))
-                return data::parse_error{data::error_code::unterminated_string, start_line, start_column};
+                return error_at(input, start_pos, data::error_code::unterminated_string);
 
             advance(input, s);
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
-            return token{token_type::quoted_string, value, start_line, start_column};
+            return token{token_type::quoted_string, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_number(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
             if (peek(input, s) == '-' || peek(input, s) == '+')
                 advance(input, s);
 
+            // 0x, 0o and 0b literals; the parser checks the digits against the base
+            if (peek(input, s) == '0' && (peek_next(input, s) == 'x' || peek_next(input, s) == 'o' || peek_next(input, s) == 'b'))
+            {
+                advance(input, s);
+                advance(input, s);
+                while (!at_end(input, s) && is_hex(peek(input, s)))
+                    advance(input, s);
+                return token{token_type::integer_literal, start_pos, s.position - start_pos};
+            }
+
             while (!at_end(input, s) && is_digit(peek(input, s)))
                 advance(input, s);
 
@@ -261,64 +286,53 @@ namespace data::yaml::detail
                     advance(input, s);
             }
 
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
             token_type type = is_float ? token_type::float_literal : token_type::integer_literal;
-            return token{type, value, start_line, start_column};
+            return token{type, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_identifier(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
 
-            while (!at_end(input, s) && (is_alnum(peek(input, s)) || peek(input, s) == '_' || peek(input, s) == '-'))
+            while (!at_end(input, s) && is_class(peek(input, s), char_class::identifier))
                 advance(input, s);
 
             std::string_view value = input.substr(start_pos, s.position - start_pos);
 
             if (value == "true" || value == "false")
-                return token{token_type::boolean_literal, value, start_line, start_column};
+                return token{token_type::boolean_literal, start_pos, s.position - start_pos};
             else if (value == "null" || value == "~")
-                return token{token_type::null_literal, value, start_line, start_column};
+                return token{token_type::null_literal, start_pos, s.position - start_pos};
 
-            return token{token_type::string_literal, value, start_line, start_column};
+            return token{token_type::string_literal, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_anchor(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
             advance(input, s);
-            while (!at_end(input, s) && (is_alnum(peek(input, s)) || peek(input, s) == '_' || peek(input, s) == '-'))
+            while (!at_end(input, s) && is_class(peek(input, s), char_class::identifier))
                 advance(input, s);
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
-            return token{token_type::anchor, value, start_line, start_column};
+            return token{token_type::anchor, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_alias(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
             advance(input, s);
-            while (!at_end(input, s) && (is_alnum(peek(input, s)) || peek(input, s) == '_' || peek(input, s) == '-'))
+            while (!at_end(input, s) && is_class(peek(input, s), char_class::identifier))
                 advance(input, s);
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
-            return token{token_type::alias, value, start_line, start_column};
+            return token{token_type::alias, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_block_scalar(std::string_view input, state &s, token_type type) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
+            std::size_t start_pos = s.position;
 
             advance(input, s); // skip | or >
 
             // Skip optional chomping/indentation indicators and rest of line
-            while (!at_end(input, s) && peek(input, s) != '\n')
-                advance(input, s);
+            s.position = line_end(input, s.position);
             if (!at_end(input, s))
                 advance(input, s); // skip \n
 
@@ -328,9 +342,8 @@ namespace data::yaml::detail
                 std::size_t probe = s.position;
                 while (probe < input.size())
                 {
-                    std::size_t indent = 0;
-                    while (probe < input.size() && input[probe] == ' ')
-                        { ++indent; ++probe; }
+                    std::size_t const indent = count_spaces(input, probe);
+                    probe += indent;
                     if (probe >= input.size() || input[probe] == '\n')
                     {
                         if (probe < input.size()) ++probe;
@@ -343,58 +356,48 @@ namespace data::yaml::detail
 
             // No indented content — empty block scalar
             if (block_indent == 0)
-                return token{type, {}, start_line, start_column};
+                return token{type, start_pos, s.position - start_pos};
 
             // Capture all lines that are blank or indented >= block_indent
-            std::size_t content_start = s.position;
             while (!at_end(input, s))
             {
-                state saved = s;
-
-                // Count indentation
-                std::size_t line_indent = 0;
-                while (!at_end(input, s) && peek(input, s) == ' ')
-                    { ++line_indent; advance(input, s); }
+                std::size_t const line_indent = count_spaces(input, s.position);
+                std::size_t const text = s.position + line_indent;
 
                 // Blank line — always part of block
-                if (at_end(input, s) || peek(input, s) == '\n')
+                if (text >= input.size() || input[text] == '\n')
                 {
-                    if (!at_end(input, s))
-                        advance(input, s);
+                    s.position = text < input.size() ? text + 1 : text;
                     continue;
                 }
 
                 // Less indentation — block ends here
                 if (line_indent < block_indent)
-                {
-                    s = saved;
                     break;
-                }
 
                 // Part of block — skip rest of line
-                while (!at_end(input, s) && peek(input, s) != '\n')
-                    advance(input, s);
+                s.position = line_end(input, text);
                 if (!at_end(input, s))
                     advance(input, s);
             }
 
-            std::string_view raw = input.substr(content_start, s.position - content_start);
-            return token{type, raw, start_line, start_column};
+            // the token spans the header line too; the parser skips it
+            return token{type, start_pos, s.position - start_pos};
         }
 
         static constexpr auto parse_tag(std::string_view input, state &s) noexcept -> std::variant<token, data::parse_error>
         {
-            std::size_t start_line = s.line;
-            std::size_t start_column = s.column;
             std::size_t start_pos = s.position;
             advance(input, s);
             if (!at_end(input, s) && peek(input, s) == '!')
                 advance(input, s);
-            while (!at_end(input, s) && peek(input, s) != ' ' && peek(input, s) != '\t' && peek(input, s) != '\n')
+            while (!at_end(input, s) && !is_class(peek(input, s), char_class::yaml_space))
                 advance(input, s);
-            std::string_view value = input.substr(start_pos, s.position - start_pos);
-            return token{token_type::tag, value, start_line, start_column};
+            return token{token_type::tag, start_pos, s.position - start_pos};
         }
+
+        std::string_view input_;
+        state s_{};
     };
 
 } // namespace data::yaml::detail
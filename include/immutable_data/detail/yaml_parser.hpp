@@ -1,7 +1,12 @@
 #pragma once
 
 #include <immutable_data/detail/yaml_lexer.hpp>
+#include <immutable_data/detail/escape.hpp>
+#include <immutable_data/detail/number.hpp>
 #include <immutable_data/detail/types.hpp>
+#include <array>
+#include <optional>
+#include <utility>
 #include <variant>
 
 namespace data::yaml::detail
@@ -9,14 +14,50 @@ namespace data::yaml::detail
 
     using namespace data::detail;
 
-    template <std::size_t MaxTokens = 1024>
+    template <typename Document = document, data::options Opts = {}>
     class parser
     {
+        static constexpr std::size_t MAX_ANCHORS = 16;
+
+        struct anchor_entry
+        {
+            token name_{}; // the anchor's token, so it is found in whatever copy of the input is parsed
+            value val_{};
+        };
+
     public:
-        constexpr explicit parser(const token_array<MaxTokens> &tokens, document &doc) noexcept
-            : tokens_{tokens}, doc_{doc} {}
+        // anchors defined so far
+        struct anchor_table
+        {
+            std::array<anchor_entry, MAX_ANCHORS> entries_{};
+            std::size_t count_{0};
+        };
+
+        // a root block mapping or sequence, parsed an entry at a time
+        struct root_block
+        {
+            value::kind kind_{value::kind::mapping};
+            std::size_t column_{0};
+        };
+
+        constexpr explicit parser(std::string_view input, Document &doc) noexcept
+            : lex_{input}, doc_{doc}
+        {
+            current_ = pull();
+            next_ = at_last() ? current_ : pull();
+        }
 
-        constexpr auto parse_document() noexcept -> std::variant<document, data::parse_error>
+        // carry on at `position`, a token where an earlier parser over the
+        // same text stopped, with the anchors it had defined; `input` may
+        // be a longer or moved copy of that text
+        constexpr parser(std::string_view input, Document &doc, std::size_t position, anchor_table const &anchors) noexcept
+            : lex_{input, position}, doc_{doc}, anchors_{anchors}
+        {
+            current_ = pull();
+            next_ = at_last() ? current_ : pull();
+        }
+
+        constexpr auto parse_document() noexcept -> std::variant<Document, data::parse_error>
         {
             if (current_token().type_ == token_type::document_start)
                 advance();
@@ -30,17 +71,137 @@ namespace data::yaml::detail
             if (std::holds_alternative<data::parse_error>(value_result))
                 return std::get<data::parse_error>(value_result);
 
-            doc_.root_ = std::get<value>(value_result);
-            return doc_;
+            if (!lex_rest())
+                return lex_error_;
+
+            doc_.set_root(std::get<value>(value_result));
+            return std::move(doc_);
+        }
+
+        // --- Entry by entry (stream_parser) ---
+        //
+        // begin_root() says whether the root is a block mapping or sequence
+        // starting a line; parse_entry() parses its entry at the current
+        // token into the container opened at `mark`, at_entry() says whether
+        // the current token starts another, and close_root() ends the root
+        // as parse_document() does. What each call decides depends only on
+        // the input up to the token after the current one.
+
+        constexpr auto begin_root() noexcept -> std::optional<root_block>
+        {
+            if (current_token().type_ == token_type::document_start)
+                advance();
+            auto const &tok = current_token();
+            if (at_last() || !starts_line(tok))
+                return std::nullopt;
+            if ((tok.type_ == token_type::string_literal || tok.type_ == token_type::quoted_string) &&
+                next_.type_ == token_type::mapping_key)
+                return root_block{value::kind::mapping, column(tok)};
+            if (tok.type_ == token_type::sequence_entry)
+                return root_block{value::kind::sequence, column(tok)};
+            return std::nullopt;
+        }
+
+        constexpr auto parse_entry(root_block const &root, std::size_t mark) noexcept
+            -> std::variant<bool, data::parse_error>
+        {
+            depth_guard guard{depth_};
+            if (root.kind_ == value::kind::mapping)
+                return parse_mapping_entry(mark);
+            return parse_sequence_entry();
+        }
+
+        [[nodiscard]] constexpr auto at_entry(root_block const &root) const noexcept -> bool
+        {
+            auto const &tok = current_token();
+            if (root.kind_ == value::kind::mapping)
+                return (tok.type_ == token_type::string_literal || tok.type_ == token_type::quoted_string) &&
+                       column(tok) == root.column_;
+            return tok.type_ == token_type::sequence_entry && column(tok) == root.column_;
+        }
+
+        constexpr auto close_root(root_block const &root, std::size_t mark) noexcept
+            -> std::variant<value, data::parse_error>
+        {
+            auto closed = root.kind_ == value::kind::mapping ? finish_mapping(mark)
+                                                             : std::variant<value, data::parse_error>{doc_.finish_sequence(mark)};
+            if (std::holds_alternative<value>(closed) && !lex_rest())
+                return lex_error_;
+            return closed;
         }
 
+        // offset of the current token
+        [[nodiscard]] constexpr auto offset() const noexcept -> std::size_t { return current_.offset_; }
+
+        // true once the parser has looked at the end of its input, so what
+        // it decided may change when more of the input is there
+        [[nodiscard]] constexpr auto reached_end() const noexcept -> bool
+        {
+            return at_last() || next_.type_ == token_type::eof || next_.type_ == token_type::invalid;
+        }
+
+        [[nodiscard]] constexpr auto anchors() const noexcept -> anchor_table const & { return anchors_; }
+
     private:
-        constexpr auto current_token() const noexcept -> const token & { return tokens_[position_]; }
-        constexpr auto advance() noexcept -> void { if (position_ < MaxTokens - 1) ++position_; }
+        constexpr auto current_token() const noexcept -> const token & { return current_; }
+        constexpr auto advance() noexcept -> void
+        {
+            if (at_last())
+                return;
+            current_ = next_;
+            if (next_.type_ != token_type::eof && next_.type_ != token_type::invalid)
+                next_ = pull();
+        }
         constexpr auto make_error(data::error_code ec) const noexcept -> data::parse_error
         {
-            auto const &tok = current_token();
-            return {ec, tok.line_, tok.column_};
+            if (lex_error_.code != data::error_code::none)
+                return lex_error_;
+            return error_at(lex_.input(), current_.offset_, ec);
+        }
+        constexpr auto text(token const &tok) const noexcept -> std::string_view { return tok.text(lex_.input()); }
+        // block structure is decided by columns, found from the token's offset
+        constexpr auto column(token const &tok) const noexcept -> std::size_t { return column_at(lex_.input(), tok.offset_); }
+
+        // only spaces before `tok` on its line
+        constexpr auto starts_line(token const &tok) const noexcept -> bool
+        {
+            auto const before = lex_.input().substr(0, tok.offset_);
+            auto const nl = before.rfind('\n');
+            return before.find_first_not_of(' ', nl == std::string_view::npos ? 0 : nl + 1) == std::string_view::npos;
+        }
+
+        // true once the current token is eof or a lexer error
+        constexpr auto at_last() const noexcept -> bool
+        {
+            return current_.type_ == token_type::eof || current_.type_ == token_type::invalid;
+        }
+
+        // next token from the lexer; a lexer error becomes an invalid token
+        // that stops the parser, and make_error() reports the lexer's error
+        constexpr auto pull() noexcept -> token
+        {
+            auto r = lex_.next();
+            if (std::holds_alternative<token>(r))
+                return std::get<token>(r);
+            lex_error_ = std::get<data::parse_error>(r);
+            return token{token_type::invalid, 0, 0};
+        }
+
+        // input after the root value is not parsed but must still lex
+        constexpr auto lex_rest() noexcept -> bool
+        {
+            while (!at_last())
+                advance();
+            return lex_error_.code == data::error_code::none;
+        }
+
+        // close the mapping opened at `mark`; duplicate keys that were not
+        // caught while staging (sorted-key documents) surface here
+        constexpr auto finish_mapping(std::size_t mark) noexcept -> std::variant<value, data::parse_error>
+        {
+            if (auto mapping = doc_.finish_mapping(mark))
+                return *mapping;
+            return make_error(data::error_code::duplicate_key);
         }
 
         struct depth_guard
@@ -59,7 +220,7 @@ namespace data::yaml::detail
             // Handle anchor: &name <value>
             if (current_token().type_ == token_type::anchor)
             {
-                auto anchor_name = current_token().value_.substr(1); // strip &
+                auto const anchor = current_token();
                 advance();
                 // Skip optional tag after anchor
                 if (current_token().type_ == token_type::tag)
@@ -67,18 +228,23 @@ namespace data::yaml::detail
                 auto value_result = parse_value();
                 if (std::holds_alternative<data::parse_error>(value_result))
                     return value_result;
-                store_anchor(anchor_name, std::get<value>(value_result));
+                store_anchor(anchor, std::get<value>(value_result));
                 return value_result;
             }
 
             // Handle alias: *name
             if (current_token().type_ == token_type::alias)
             {
-                auto alias_name = current_token().value_.substr(1); // strip *
+                auto alias_name = text(current_token()).substr(1); // strip *
                 advance();
                 auto *anchored = find_anchor(alias_name);
                 if (!anchored)
                     return make_error(data::error_code::cyclic_reference);
+                // a streamed container left no nodes to replay, and a decoded
+                // string's bytes are reused once it has been delivered
+                if constexpr (event_sink<Document>)
+                    if (anchored->is_sequence() || anchored->is_mapping() || anchored->in_arena_)
+                        return make_error(data::error_code::unsupported_feature);
                 return *anchored;
             }
 
@@ -86,7 +252,7 @@ namespace data::yaml::detail
             if (current_token().type_ == token_type::tag)
                 advance();
 
-            const auto &tok = current_token();
+            auto const tok = current_token();
             switch (tok.type_)
             {
             case token_type::null_literal:
@@ -94,15 +260,14 @@ namespace data::yaml::detail
                 return value::make_null();
             case token_type::boolean_literal:
                 advance();
-                return value::make_bool(tok.value_ == "true");
+                return value::make_bool(text(tok) == "true");
             case token_type::integer_literal:
                 return parse_integer();
             case token_type::float_literal:
                 return parse_float();
             case token_type::string_literal:
             case token_type::quoted_string:
-                if (position_ + 1 < MaxTokens &&
-                    tokens_[position_ + 1].type_ == token_type::mapping_key)
+                if (next_.type_ == token_type::mapping_key)
                     return parse_block_mapping();
                 return parse_string_value();
             case token_type::literal_string:
@@ -122,56 +287,65 @@ namespace data::yaml::detail
 
         constexpr auto parse_integer() noexcept -> std::variant<value, data::parse_error>
         {
-            const auto &tok = current_token();
+            auto const t = text(current_token());
+            auto const n = data::detail::parse_integer(t);
+            if (n.status == integer_status::invalid)
+                return make_error(data::error_code::invalid_syntax);
+            if (n.status == integer_status::overflow)
+            {
+                auto const f = Opts.overflow_to_float ? data::detail::parse_float(t) : std::nullopt;
+                if (!f)
+                    return make_error(data::error_code::integer_overflow);
+                advance();
+                return value::make_float(*f);
+            }
             advance();
-            integer result = 0;
-            bool negative = false;
-            std::size_t i = 0;
-            if (!tok.value_.empty() && tok.value_[0] == '-') { negative = true; i = 1; }
-            else if (!tok.value_.empty() && tok.value_[0] == '+') { i = 1; }
-            for (; i < tok.value_.size(); ++i)
-                if (is_digit(tok.value_[i]))
-                    result = result * 10 + (tok.value_[i] - '0');
-            return value::make_int(negative ? -result : result);
+            return value::make_int(n.value);
         }
 
         constexpr auto parse_float() noexcept -> std::variant<value, data::parse_error>
         {
-            const auto &tok = current_token();
+            auto const v = data::detail::parse_float(text(current_token()));
+            if (!v)
+                return make_error(data::error_code::invalid_syntax);
             advance();
-            floating result = 0.0;
-            floating decimal_place = 0.1;
-            bool negative = false;
-            bool in_decimal = false;
-            std::size_t i = 0;
-            if (!tok.value_.empty() && tok.value_[0] == '-') { negative = true; i = 1; }
-            else if (!tok.value_.empty() && tok.value_[0] == '+') { i = 1; }
-            for (; i < tok.value_.size(); ++i)
-            {
-                char c = tok.value_[i];
-                if (is_digit(c))
-                {
-                    if (in_decimal) { result += (c - '0') * decimal_place; decimal_place *= 0.1; }
-                    else { result = result * 10.0 + (c - '0'); }
-                }
-                else if (c == '.') { in_decimal = true; }
-                else if (c == 'e' || c == 'E') { break; }
-            }
-            return value::make_float(negative ? -result : result);
+            return value::make_float(*v);
         }
 
-        constexpr auto parse_string_raw() noexcept -> std::variant<string_type, data::parse_error>
+        constexpr auto parse_string_raw() noexcept -> std::variant<string_ref, data::parse_error>
         {
-            const auto &tok = current_token();
-            advance();
-            if (tok.type_ == token_type::quoted_string)
+            auto const tok = current_token();
+            if (tok.type_ != token_type::quoted_string)
             {
-                std::string_view content = tok.value_;
-                if (content.size() >= 2)
-                    content = content.substr(1, content.size() - 2);
-                return string_type{content};
+                auto const kept = source_string<Opts>(doc_, text(tok));
+                if (!kept)
+                    return make_error(data::error_code::string_overflow);
+                advance();
+                return *kept;
+            }
+            std::string_view content = text(tok);
+            bool const double_quoted = content.front() == '"';
+            if (content.size() >= 2)
+                content = content.substr(1, content.size() - 2);
+            // only double-quoted scalars have escapes
+            auto const escape = double_quoted ? find_escape(content) : content.size();
+            if (escape == content.size())
+            {
+                auto const kept = source_string<Opts>(doc_, content);
+                if (!kept)
+                    return make_error(data::error_code::string_overflow);
+                advance();
+                return *kept;
             }
-            return string_type{tok.value_};
+
+            if (!doc_.can_store(max_decoded_size<escape_dialect::yaml>(content.size())))
+                return make_error(data::error_code::string_overflow);
+            advance();
+
+            auto start = doc_.chars_size_;
+            if (auto const bad = decode_escapes<escape_dialect::yaml>(content, escape, doc_); bad != std::string_view::npos)
+                return error_at(lex_.input(), tok.offset_ + 1 + bad, data::error_code::invalid_escape_sequence);
+            return doc_.commit(start);
         }
 
         constexpr auto parse_string_value() noexcept -> std::variant<value, data::parse_error>
@@ -179,17 +353,24 @@ namespace data::yaml::detail
             auto result = parse_string_raw();
             if (std::holds_alternative<data::parse_error>(result))
                 return std::get<data::parse_error>(result);
-            return value::make_string(std::get<string_type>(result));
+            return value::make_string(std::get<string_ref>(result));
         }
 
         constexpr auto parse_block_scalar(bool literal) noexcept -> std::variant<value, data::parse_error>
         {
-            const auto &tok = current_token();
+            auto const tok = current_token();
             advance();
 
-            std::string_view raw = tok.value_;
+            // skip the header line (indicator, chomping, comment)
+            std::string_view raw = text(tok);
+            auto const header_end = raw.find('\n');
+            raw = header_end == std::string_view::npos ? std::string_view{} : raw.substr(header_end + 1);
             if (raw.empty())
-                return value::make_string(string_type{});
+                return value::make_string(string_ref{});
+
+            // Folded text is never longer than the raw block
+            if (!doc_.can_store(raw.size()))
+                return make_error(data::error_code::string_overflow);
 
             // Find block indentation from first non-blank line
             std::size_t block_indent = 0;
@@ -210,7 +391,7 @@ namespace data::yaml::detail
                 }
             }
 
-            string_type result{};
+            auto start = doc_.chars_size_;
             std::size_t i = 0;
 
             if (literal)
@@ -229,18 +410,18 @@ namespace data::yaml::detail
                     // Blank line
                     if (raw[i] == '\n')
                     {
-                        result.push_back('\n');
+                        doc_.append('\n');
                         ++i;
                         continue;
                     }
 
                     if (!first_line)
-                        result.push_back('\n');
+                        doc_.append('\n');
                     first_line = false;
 
                     // Copy line content
                     while (i < raw.size() && raw[i] != '\n')
-                        result.push_back(raw[i++]);
+                        doc_.append(raw[i++]);
                     if (i < raw.size()) ++i; // skip \n
                 }
             }
@@ -262,7 +443,7 @@ namespace data::yaml::detail
                     if (raw[i] == '\n')
                     {
                         if (!first_content)
-                            result.push_back('\n');
+                            doc_.append('\n');
                         prev_was_blank = true;
                         ++i;
                         continue;
@@ -270,25 +451,24 @@ namespace data::yaml::detail
 
                     // Non-blank line — space-join with previous unless after blank
                     if (!first_content && !prev_was_blank)
-                        result.push_back(' ');
+                        doc_.append(' ');
                     first_content = false;
                     prev_was_blank = false;
 
                     // Copy line content
                     while (i < raw.size() && raw[i] != '\n')
-                        result.push_back(raw[i++]);
+                        doc_.append(raw[i++]);
                     if (i < raw.size()) ++i; // skip \n
                 }
             }
 
-            return value::make_string(result);
+            return value::make_string(doc_.commit(start));
         }
 
         constexpr auto parse_flow_sequence() noexcept -> std::variant<value, data::parse_error>
         {
             advance(); // skip [
-            std::array<value, DATA_CT_MAX_ITEMS> temp{};
-            std::size_t count = 0;
+            auto const mark = open_container(doc_, value::kind::sequence);
             bool expect_value = true;
 
             while (current_token().type_ != token_type::sequence_end &&
@@ -306,31 +486,21 @@ namespace data::yaml::detail
                 auto value_result = parse_value();
                 if (std::holds_alternative<data::parse_error>(value_result))
                     return std::get<data::parse_error>(value_result);
-                if (count >= DATA_CT_MAX_ITEMS) return make_error(data::error_code::invalid_syntax);
-                temp[count++] = std::get<value>(value_result);
+                if (!doc_.stage(std::get<value>(value_result)))
+                    return make_error(data::error_code::pool_overflow);
                 expect_value = false;
             }
 
-            if (expect_value && count > 0) return make_error(data::error_code::unexpected_token);
+            if (expect_value && doc_.staged(mark) > 0) return make_error(data::error_code::unexpected_token);
             if (current_token().type_ == token_type::sequence_end) advance();
 
-            if (!doc_.can_alloc(count))
-                return make_error(data::error_code::pool_overflow);
-            auto start = doc_.pool_size_;
-            for (std::size_t i = 0; i < count; ++i)
-            {
-                doc_.pool_[doc_.pool_size_].key = string_type{};
-                doc_.pool_[doc_.pool_size_].val_ = temp[i];
-                doc_.pool_size_++;
-            }
-            return value::make_sequence(start, count);
+            return doc_.finish_sequence(mark);
         }
 
         constexpr auto parse_flow_mapping() noexcept -> std::variant<value, data::parse_error>
         {
             advance(); // skip {
-            std::array<pool_entry, DATA_CT_MAX_ITEMS> temp{};
-            std::size_t count = 0;
+            auto const mark = open_container(doc_, value::kind::mapping);
             bool expect_key = true;
 
             while (current_token().type_ != token_type::mapping_end &&
@@ -348,137 +518,129 @@ namespace data::yaml::detail
                 auto key_result = parse_string_raw();
                 if (std::holds_alternative<data::parse_error>(key_result))
                     return std::get<data::parse_error>(key_result);
-                auto key = std::get<string_type>(key_result);
+                auto key = std::get<string_ref>(key_result);
 
-                for (std::size_t j = 0; j < count; ++j)
-                    if (temp[j].key.view() == key.view())
-                        return make_error(data::error_code::duplicate_key);
+                if (doc_.is_staged(mark, key.view()))
+                    return make_error(data::error_code::duplicate_key);
 
                 if (current_token().type_ != token_type::mapping_key)
                     return make_error(data::error_code::unexpected_token);
                 advance();
+                announce_key(doc_, key);
 
                 auto value_result = parse_value();
                 if (std::holds_alternative<data::parse_error>(value_result))
                     return std::get<data::parse_error>(value_result);
-                if (count >= DATA_CT_MAX_ITEMS) return make_error(data::error_code::invalid_syntax);
-                temp[count++] = pool_entry{std::move(key), std::get<value>(value_result)};
+                if (!doc_.stage(key, std::get<value>(value_result)))
+                    return make_error(data::error_code::pool_overflow);
                 expect_key = false;
             }
 
-            if (expect_key && count > 0) return make_error(data::error_code::unexpected_token);
+            if (expect_key && doc_.staged(mark) > 0) return make_error(data::error_code::unexpected_token);
             if (current_token().type_ == token_type::mapping_end) advance();
 
-            if (!doc_.can_alloc(count))
-                return make_error(data::error_code::pool_overflow);
-            auto start = doc_.pool_size_;
-            for (std::size_t i = 0; i < count; ++i)
-                doc_.pool_[doc_.pool_size_++] = temp[i];
-            return value::make_mapping(start, count);
+            return finish_mapping(mark);
         }
 
         constexpr auto parse_block_sequence() noexcept -> std::variant<value, data::parse_error>
         {
-            std::array<value, DATA_CT_MAX_ITEMS> temp{};
-            std::size_t count = 0;
-            auto expected_col = current_token().column_;
+            auto const mark = open_container(doc_, value::kind::sequence);
+            auto expected_col = column(current_token());
 
             while (current_token().type_ == token_type::sequence_entry &&
-                   current_token().column_ == expected_col)
+                   column(current_token()) == expected_col)
             {
-                advance(); // skip -
-                auto value_result = parse_value();
-                if (std::holds_alternative<data::parse_error>(value_result))
-                    return std::get<data::parse_error>(value_result);
-                if (count >= DATA_CT_MAX_ITEMS) return make_error(data::error_code::invalid_syntax);
-                temp[count++] = std::get<value>(value_result);
+                auto entry = parse_sequence_entry();
+                if (std::holds_alternative<data::parse_error>(entry))
+                    return std::get<data::parse_error>(entry);
             }
 
-            if (!doc_.can_alloc(count))
+            return doc_.finish_sequence(mark);
+        }
+
+        // "- value", staged in the open sequence
+        constexpr auto parse_sequence_entry() noexcept -> std::variant<bool, data::parse_error>
+        {
+            advance(); // skip -
+            auto value_result = parse_value();
+            if (std::holds_alternative<data::parse_error>(value_result))
+                return std::get<data::parse_error>(value_result);
+            if (!doc_.stage(std::get<value>(value_result)))
                 return make_error(data::error_code::pool_overflow);
-            auto start = doc_.pool_size_;
-            for (std::size_t i = 0; i < count; ++i)
-            {
-                doc_.pool_[doc_.pool_size_].key = string_type{};
-                doc_.pool_[doc_.pool_size_].val_ = temp[i];
-                doc_.pool_size_++;
-            }
-            return value::make_sequence(start, count);
+            return true;
         }
 
         constexpr auto parse_block_mapping() noexcept -> std::variant<value, data::parse_error>
         {
-            std::array<pool_entry, DATA_CT_MAX_ITEMS> temp{};
-            std::size_t count = 0;
-            auto expected_col = current_token().column_;
+            auto const mark = open_container(doc_, value::kind::mapping);
+            auto expected_col = column(current_token());
 
             while ((current_token().type_ == token_type::string_literal ||
                     current_token().type_ == token_type::quoted_string) &&
-                   current_token().column_ == expected_col)
+                   column(current_token()) == expected_col)
             {
-                auto key_result = parse_string_raw();
-                if (std::holds_alternative<data::parse_error>(key_result))
-                    return std::get<data::parse_error>(key_result);
-                auto key = std::get<string_type>(key_result);
+                auto entry = parse_mapping_entry(mark);
+                if (std::holds_alternative<data::parse_error>(entry))
+                    return std::get<data::parse_error>(entry);
+            }
 
-                for (std::size_t j = 0; j < count; ++j)
-                    if (temp[j].key.view() == key.view())
-                        return make_error(data::error_code::duplicate_key);
+            return finish_mapping(mark);
+        }
 
-                if (current_token().type_ != token_type::mapping_key)
-                    return make_error(data::error_code::unexpected_token);
-                advance();
+        // "key: value", staged in the mapping opened at `mark`
+        constexpr auto parse_mapping_entry(std::size_t mark) noexcept -> std::variant<bool, data::parse_error>
+        {
+            auto key_result = parse_string_raw();
+            if (std::holds_alternative<data::parse_error>(key_result))
+                return std::get<data::parse_error>(key_result);
+            auto key = std::get<string_ref>(key_result);
 
-                auto value_result = parse_value();
-                if (std::holds_alternative<data::parse_error>(value_result))
-                    return std::get<data::parse_error>(value_result);
-                if (count >= DATA_CT_MAX_ITEMS) return make_error(data::error_code::invalid_syntax);
-                temp[count++] = pool_entry{std::move(key), std::get<value>(value_result)};
-            }
+            if (doc_.is_staged(mark, key.view()))
+                return make_error(data::error_code::duplicate_key);
 
-            if (!doc_.can_alloc(count))
+            if (current_token().type_ != token_type::mapping_key)
+                return make_error(data::error_code::unexpected_token);
+            advance();
+            announce_key(doc_, key);
+
+            auto value_result = parse_value();
+            if (std::holds_alternative<data::parse_error>(value_result))
+                return std::get<data::parse_error>(value_result);
+            if (!doc_.stage(key, std::get<value>(value_result)))
                 return make_error(data::error_code::pool_overflow);
-            auto start = doc_.pool_size_;
-            for (std::size_t i = 0; i < count; ++i)
-                doc_.pool_[doc_.pool_size_++] = temp[i];
-            return value::make_mapping(start, count);
+            return true;
         }
 
         // --- Anchor/alias storage ---
-        static constexpr std::size_t MAX_ANCHORS = 16;
-
-        struct anchor_entry
-        {
-            string_type name{};
-            value val_{};
-        };
 
-        constexpr void store_anchor(std::string_view name, value const &v) noexcept
+        constexpr void store_anchor(token const &anchor, value const &v) noexcept
         {
-            for (std::size_t i = 0; i < anchor_count_; ++i)
-                if (anchors_[i].name.view() == name)
+            auto const name = text(anchor).substr(1); // strip &
+            for (std::size_t i = 0; i < anchors_.count_; ++i)
+                if (text(anchors_.entries_[i].name_).substr(1) == name)
                 {
-                    anchors_[i].val_ = v;
+                    anchors_.entries_[i].val_ = v;
                     return;
                 }
-            if (anchor_count_ < MAX_ANCHORS)
-                anchors_[anchor_count_++] = anchor_entry{string_type{name}, v};
+            if (anchors_.count_ < MAX_ANCHORS)
+                anchors_.entries_[anchors_.count_++] = anchor_entry{anchor, v};
         }
 
         constexpr auto find_anchor(std::string_view name) const noexcept -> value const *
         {
-            for (std::size_t i = 0; i < anchor_count_; ++i)
-                if (anchors_[i].name.view() == name)
-                    return &anchors_[i].val_;
+            for (std::size_t i = 0; i < anchors_.count_; ++i)
+                if (text(anchors_.entries_[i].name_).substr(1) == name)
+                    return &anchors_.entries_[i].val_;
             return nullptr;
         }
 
-        const token_array<MaxTokens> &tokens_;
-        document &doc_;
-        std::size_t position_{0};
+        lexer lex_;
+        Document &doc_;
+        data::parse_error lex_error_{};
+        token current_{};
+        token next_{}; // one token of lookahead: a scalar followed by ':' is a key
         std::size_t depth_{0};
-        std::array<anchor_entry, MAX_ANCHORS> anchors_{};
-        std::size_t anchor_count_{0};
+        anchor_table anchors_{};
     };
 
 } // namespace data::yaml::detail
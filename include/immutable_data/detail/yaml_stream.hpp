@@ -0,0 +1,331 @@
+#pragma once
+
+// Chunked YAML input. Block structure is decided by indentation that only
+// whole lines settle, so chunks are gathered in a buffer while a resumable
+// line scanner watches for the end of the document: a "..." line, a "---"
+// line after content, or finish(). A root block mapping or sequence is parsed
+// an entry at a time as lines arrive — an entry is settled by the next line
+// that starts one at the root's column — and the rest when the document ends.
+// Strings are copied into the document, as the buffer moves while it grows.
+
+#include <immutable_data/detail/pmr_document.hpp>
+#include <immutable_data/detail/types.hpp>
+#include <immutable_data/detail/yaml_parser.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace data::yaml::detail
+{
+
+    using namespace data::detail;
+
+    //   stream_parser p{&resource};
+    //   while (p.feed(read_some()) == data::stream_status::need_more) {}
+    //
+    // The buffer and the document grow from `resource`. A marker line ends
+    // the document once its next byte arrives; a stream that just stops needs
+    // finish(). Errors carry the same codes and positions as parse(), and one
+    // in a root entry is reported as soon as the entry is settled.
+    template <data::options Opts = {}>
+    class stream_parser
+    {
+        static constexpr data::options parse_opts = []
+        {
+            auto o = Opts;
+            o.reference_source = false;
+            return o;
+        }();
+
+    public:
+        using document_type = options_pmr_document<Opts>;
+
+        explicit stream_parser(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept
+            : buffer_{resource}, resource_{resource}
+        {
+        }
+
+        // take the next chunk; need_more until the document has ended
+        auto feed(std::span<char const> chunk) noexcept -> stream_status
+        {
+            consumed_ = 0;
+            if (status_ != stream_status::need_more)
+                return status_;
+            std::string_view const in{chunk.data(), chunk.size()};
+            auto const end = scan(in);
+            consumed_ = end ? *end : in.size();
+            try
+            {
+                buffer_.insert(buffer_.end(), in.begin(), in.begin() + static_cast<std::ptrdiff_t>(consumed_));
+            }
+            catch (std::bad_alloc const &)
+            {
+                return fail({data::error_code::string_overflow, 0, 0});
+            }
+            if (end)
+                parse(line_begin_);
+            else
+                parse_entries();
+            return status_;
+        }
+
+        // the input has ended: parse what has been fed
+        auto finish() noexcept -> stream_status
+        {
+            if (status_ == stream_status::need_more)
+                parse(buffer_.size());
+            return status_;
+        }
+
+        [[nodiscard]] auto status() const noexcept -> stream_status { return status_; }
+        [[nodiscard]] auto error() const noexcept -> data::parse_error { return error_; }
+
+        // bytes of the last chunk that belong to the document, its closing
+        // marker included; the rest is left for the next document
+        [[nodiscard]] auto consumed() const noexcept -> std::size_t { return consumed_; }
+
+        // the parsed document — only valid once status() is done
+        [[nodiscard]] auto document() const noexcept -> document_type const & { return *doc_; }
+
+    private:
+        using parser_type = parser<document_type, parse_opts>;
+
+        // how the root is being parsed
+        enum class mode : std::uint8_t
+        {
+            undecided, // no content yet
+            entries,   // a root block, an entry at a time
+            whole,     // anything else, once the document has ended
+        };
+
+        std::pmr::vector<char> buffer_;
+        std::pmr::memory_resource *resource_;
+        std::optional<document_type> doc_;
+        std::size_t line_begin_{0};     // offset of the current line in the stream
+        std::array<char, 4> head_{};    // the line's first bytes, to spot a marker
+        std::size_t head_size_{0};
+        bool head_done_{false};
+        bool settled_{false};           // nothing else on this line matters
+        bool content_{false};           // a "---" from here on starts the next document
+        mode mode_{mode::undecided};
+        typename parser_type::root_block root_{};
+        typename parser_type::anchor_table anchors_{};
+        std::size_t mark_{0};           // where the root's entries are staged
+        std::size_t entry_{0};          // offset of the root's first unsettled entry
+        std::size_t checked_{0};        // lines before this offset have been looked at
+        std::size_t retry_{0};          // an unsettled entry is tried again from here
+        std::size_t consumed_{0};
+        stream_status status_{stream_status::need_more};
+        data::parse_error error_{};
+
+        auto fail(data::parse_error e) noexcept -> stream_status
+        {
+            error_ = e;
+            status_ = stream_status::error;
+            return status_;
+        }
+
+        // how much of `in` precedes the end of the document, if it ends in it
+        auto scan(std::string_view in) noexcept -> std::optional<std::size_t>
+        {
+            auto const base = buffer_.size();
+            for (std::size_t i = 0; i < in.size(); ++i)
+            {
+                auto const c = in[i];
+                if (c == '\n')
+                {
+                    if (!head_done_ && end_of_head())
+                        return i;
+                    line_begin_ = base + i + 1;
+                    head_size_ = 0;
+                    head_done_ = false;
+                    settled_ = false;
+                    continue;
+                }
+                if (settled_)
+                {
+                    auto const nl = in.find('\n', i);
+                    if (nl == std::string_view::npos)
+                        break;
+                    i = nl - 1;
+                    continue;
+                }
+                if (head_done_)
+                {
+                    look(c);
+                    continue;
+                }
+                head_[head_size_++] = c;
+                if (head_size_ == head_.size() && end_of_head())
+                    return i;
+            }
+            return std::nullopt;
+        }
+
+        // the line's head is complete: true if it is a marker that ends the
+        // document — the byte after it is not part of the document
+        auto end_of_head() noexcept -> bool
+        {
+            head_done_ = true;
+            std::string_view const head{head_.data(), head_size_};
+            auto const marker = (head.starts_with("---") || head.starts_with("...")) &&
+                                (head.size() == 3 || head[3] == ' ' || head[3] == '\t' || head[3] == '\r');
+            if (marker)
+                return head[0] == '.' || content_;
+            for (auto const c : head)
+                look(c);
+            return false;
+        }
+
+        // the first byte on a line that is not blank decides it: a comment
+        // or content
+        auto look(char c) noexcept -> void
+        {
+            if (settled_ || c == ' ' || c == '\t' || c == '\r')
+                return;
+            content_ = content_ || c != '#';
+            settled_ = true;
+        }
+
+        // look at the lines completed since the last chunk
+        auto parse_entries() noexcept -> void
+        {
+            while (status_ == stream_status::need_more && mode_ != mode::whole && checked_ < line_begin_)
+            {
+                std::string_view const text{buffer_.data(), buffer_.size()};
+                auto const first = text.find_first_not_of(' ', checked_);
+                auto const line = checked_;
+                checked_ = text.find('\n', line) + 1;
+                if (checked_ <= retry_)
+                    continue;
+                if (mode_ == mode::undecided)
+                    begin(text.substr(0, checked_));
+                else if (starts_entry(text.substr(first, checked_ - first), first - line))
+                    settle(text.substr(0, checked_), first);
+            }
+        }
+
+        // decide how the root is parsed from the lines so far, unless that
+        // needs a look past them
+        auto begin(std::string_view text) noexcept -> void
+        {
+            if (!doc_)
+                doc_.emplace(resource_);
+            parser_type p{text, *doc_};
+            auto const root = p.begin_root();
+            if (root)
+            {
+                mode_ = mode::entries;
+                root_ = *root;
+                mark_ = open_container(*doc_, root_.kind_);
+                entry_ = p.offset();
+                retry_ = 0;
+            }
+            else if (!p.reached_end())
+                mode_ = mode::whole;
+            else
+                retry_ = text.size() * 2; // nothing yet, or a token that may go on
+        }
+
+        // true if a line whose content `rest` starts at `column` (from 0)
+        // could start an entry of the root: "- " for a sequence, anything
+        // but a comment for a mapping
+        [[nodiscard]] auto starts_entry(std::string_view rest, std::size_t column) const noexcept -> bool
+        {
+            if (column != root_.column_ - 1 || rest[0] == '#' || rest[0] == '\n' || rest[0] == '\r')
+                return false;
+            auto const dash = rest[0] == '-' && (rest[1] == ' ' || rest[1] == '\t' || rest[1] == '\n' || rest[1] == '\r');
+            return dash == (root_.kind_ == value::kind::sequence);
+        }
+
+        // parse the unsettled entries over `text`, which ends with a line
+        // that may start another at `next`: an entry is settled when parsing
+        // it stops at the start of the next one, which lies in `text`
+        auto settle(std::string_view text, std::size_t next) noexcept -> void
+        {
+            parser_type p{text, *doc_, entry_, anchors_};
+            while (p.offset() < next)
+            {
+                auto const top = doc_->mark();
+                auto const r = p.parse_entry(root_, mark_);
+                auto const ok = std::holds_alternative<bool>(r);
+                if (ok && p.at_entry(root_))
+                {
+                    entry_ = p.offset();
+                    anchors_ = p.anchors();
+                    retry_ = 0;
+                    continue;
+                }
+                if (!ok && !p.reached_end())
+                {
+                    fail(std::get<data::parse_error>(r));
+                    return;
+                }
+                doc_->unstage(top);
+                if (ok && !p.reached_end())
+                    retry_ = std::numeric_limits<std::size_t>::max(); // the root ends before `next`
+                else // wait for as much again; a failed try rescans the whole text for its error's line
+                    retry_ = text.size() + std::max(text.size() - entry_, text.size() / 8);
+                return;
+            }
+        }
+
+        auto parse(std::size_t size) noexcept -> void
+        {
+            std::string_view const text{buffer_.data(), size};
+            if (text.empty())
+            {
+                fail({data::error_code::invalid_syntax, 0, 0});
+                return;
+            }
+            if (mode_ == mode::entries)
+            {
+                close(text);
+                return;
+            }
+            document_type doc{resource_};
+            auto r = parser_type{text, doc}.parse_document();
+            if (std::holds_alternative<data::parse_error>(r))
+            {
+                fail(std::get<data::parse_error>(r));
+                return;
+            }
+            doc_.emplace(std::get<document_type>(std::move(r)));
+            status_ = stream_status::done;
+        }
+
+        // the document has ended: parse the root's remaining entries
+        auto close(std::string_view text) noexcept -> void
+        {
+            parser_type p{text, *doc_, entry_, anchors_};
+            while (p.at_entry(root_))
+            {
+                auto const r = p.parse_entry(root_, mark_);
+                if (std::holds_alternative<data::parse_error>(r))
+                {
+                    fail(std::get<data::parse_error>(r));
+                    return;
+                }
+            }
+            auto const root = p.close_root(root_, mark_);
+            if (std::holds_alternative<data::parse_error>(root))
+            {
+                fail(std::get<data::parse_error>(root));
+                return;
+            }
+            doc_->set_root(std::get<value>(root));
+            status_ = stream_status::done;
+        }
+    };
+
+} // namespace data::yaml::detail
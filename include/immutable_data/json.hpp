@@ -1,42 +1,118 @@
 #pragma once
 
+#include <immutable_data/detail/exact_document.hpp>
 #include <immutable_data/detail/json_lexer.hpp>
 #include <immutable_data/detail/json_parser.hpp>
+#include <immutable_data/detail/pmr_document.hpp>
+#include <immutable_data/detail/sax.hpp>
+#include <immutable_data/detail/json_stream.hpp>
 #include <immutable_data/detail/types.hpp>
 
+#include <memory_resource>
 #include <string_view>
+#include <utility>
 #include <variant>
 
-#ifndef DATA_CT_MAX_TOKENS
-#define DATA_CT_MAX_TOKENS 1024
-#endif
-
 namespace data::json
 {
 
     using data::detail::document;
+    using data::detail::pmr_document;
+    using detail::stream_parser;
     using data::parse_error;
 
     template <typename T>
     using result = std::variant<T, parse_error>;
 
+    namespace detail
+    {
+        // parse into a document of the given type; the parser pulls tokens
+        // from the lexer as it goes
+        struct format
+        {
+            template <typename Document, data::options Opts = {}, typename... Args>
+            static constexpr auto parse(std::string_view input, Args &&...args) noexcept
+                -> std::variant<Document, parse_error>
+            {
+                Document doc{std::forward<Args>(args)...};
+                return parse_into<Opts>(input, doc);
+            }
+
+            // parse into a document the caller keeps alive, such as a
+            // sax_document whose handler hears the root after parsing
+            template <data::options Opts, typename Document>
+            static constexpr auto parse_into(std::string_view input, Document &doc) noexcept
+                -> std::variant<Document, parse_error>
+            {
+                auto p = parser<Document, Opts>{input, doc};
+                return p.parse_document();
+            }
+        };
+    } // namespace detail
+
     template <std::size_t N>
     constexpr auto parse(const char (&str)[N]) noexcept -> result<document>
     {
         if constexpr (N <= 1)
             return parse_error{error_code::invalid_syntax, 0, 0};
 
-        std::string_view view{str, N - 1};
-        detail::lexer<DATA_CT_MAX_TOKENS> lex{};
-        auto tokens_result = lex.tokenize(view);
+        return detail::format::parse<document>({str, N - 1});
+    }
 
-        if (std::holds_alternative<parse_error>(tokens_result))
-            return std::get<parse_error>(tokens_result);
+    // same limits, with the document layout `Opts` selects
+    template <data::options Opts, std::size_t N>
+    constexpr auto parse(const char (&str)[N]) noexcept -> result<data::detail::options_document<Opts>>
+    {
+        if constexpr (N <= 1)
+            return parse_error{error_code::invalid_syntax, 0, 0};
 
-        auto const &tokens = std::get<data::detail::token_array<DATA_CT_MAX_TOKENS>>(tokens_result);
-        data::detail::document doc{};
-        auto parser = detail::parser<DATA_CT_MAX_TOKENS>{tokens, doc};
-        return parser.parse_document();
+        return detail::format::parse<data::detail::options_document<Opts>, Opts>({str, N - 1});
+    }
+
+    // runtime input, such as a file read at startup; same limits and error
+    // codes. Strings are copied into the document, which does not
+    // reference `input` once parse returns — unless Opts.reference_source
+    // is set, and then `input` must outlive the document.
+    template <data::options Opts = {}>
+    constexpr auto parse(std::string_view input) noexcept -> result<data::detail::options_document<Opts>>
+    {
+        if (input.empty())
+            return parse_error{error_code::invalid_syntax, 0, 0};
+
+        return detail::format::parse<data::detail::options_document<Opts>, Opts>(input);
+    }
+
+    // runtime input into a document whose pool, arena and indexes grow from
+    // `resource` — a monotonic buffer, a per-thread pool — instead of being
+    // capped by the DATA_CT_MAX_* limits. The resource must outlive the
+    // document.
+    template <data::options Opts = {}>
+    auto parse(std::string_view input, std::pmr::memory_resource *resource) noexcept
+        -> result<data::detail::options_pmr_document<Opts>>
+    {
+        if (input.empty())
+            return parse_error{error_code::invalid_syntax, 0, 0};
+
+        return detail::format::parse<data::detail::options_pmr_document<Opts>, Opts>(input, resource);
+    }
+
+    // exact-size document — sized to the nodes and decoded bytes the source needs
+    template <data::detail::fixed_string Src, data::options Opts = {}>
+    using exact_document = typename data::detail::exact_document<Src, detail::format, Opts>::type;
+
+    template <data::detail::fixed_string Src, data::options Opts = {}>
+    constexpr auto parse() noexcept -> result<exact_document<Src, Opts>>
+    {
+        return data::detail::exact_document<Src, detail::format, Opts>::value;
+    }
+
+    // stream `input` to `handler` as parse events instead of building a
+    // document (see detail/sax.hpp for the events); error_code::none on
+    // success. Duplicate keys are not reported.
+    template <data::options Opts = {}, typename Handler>
+    constexpr auto sax_parse(std::string_view input, Handler &handler) noexcept -> parse_error
+    {
+        return data::detail::sax_parse<detail::format, Opts>(input, handler);
     }
 
     template <std::size_t N>
@@ -48,6 +124,33 @@ namespace data::json
         throw "JSON parse error";
     }
 
+    template <data::options Opts, std::size_t N>
+    constexpr auto parse_or_throw(const char (&str)[N]) -> data::detail::options_document<Opts>
+    {
+        auto r = parse<Opts>(str);
+        if (std::holds_alternative<data::detail::options_document<Opts>>(r))
+            return std::get<data::detail::options_document<Opts>>(r);
+        throw "JSON parse error";
+    }
+
+    template <data::options Opts = {}>
+    constexpr auto parse_or_throw(std::string_view input) -> data::detail::options_document<Opts>
+    {
+        auto r = parse<Opts>(input);
+        if (std::holds_alternative<data::detail::options_document<Opts>>(r))
+            return std::get<data::detail::options_document<Opts>>(r);
+        throw "JSON parse error";
+    }
+
+    template <data::detail::fixed_string Src, data::options Opts = {}>
+    constexpr auto parse_or_throw() -> exact_document<Src, Opts>
+    {
+        auto r = parse<Src, Opts>();
+        if (std::holds_alternative<exact_document<Src, Opts>>(r))
+            return std::get<exact_document<Src, Opts>>(r);
+        throw "JSON parse error";
+    }
+
     template <std::size_t N>
     constexpr auto is_valid(const char (&str)[N]) noexcept -> bool
     {
@@ -55,4 +158,10 @@ namespace data::json
         return std::holds_alternative<document>(r);
     }
 
+    constexpr auto is_valid(std::string_view input) noexcept -> bool
+    {
+        auto r = parse(input);
+        return std::holds_alternative<document>(r);
+    }
+
 } // namespace data::json
@@ -0,0 +1,91 @@
+#pragma once
+
+// load_file.hpp — parse a data file at runtime straight from a read-only
+// memory mapping
+//
+//   auto r = data::load_file<data::file_format::yaml>("/etc/service.yaml");
+//   auto const &cfg = std::get<data::mapped_document<>>(r);
+//   cfg.find(cfg.root_, "port");
+//
+// Keys and strings without escapes view the mapping itself, so their bytes
+// stay in the page cache shared by every process that maps the file; only
+// decoded strings are copied, into the document's arena. The document owns
+// the mapping and unmaps it when destroyed. Nodes, indexes and the arena
+// grow from the given memory resource, as with parse(text, resource).
+
+#include <immutable_data/detail/file_mapping.hpp>
+#include <immutable_data/detail/pmr_document.hpp>
+#include <immutable_data/json.hpp>
+#include <immutable_data/toml.hpp>
+#include <immutable_data/xml.hpp>
+#include <immutable_data/yaml.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory_resource>
+#include <utility>
+#include <variant>
+
+namespace data
+{
+
+    enum class file_format : std::uint8_t
+    {
+        json,
+        yaml,
+        toml,
+        xml,
+    };
+
+    // a pmr_document that owns the file mapping its strings view
+    template <bool SortedKeys = false>
+    class mapped_document : public detail::pmr_document<SortedKeys>
+    {
+    public:
+        mapped_document(detail::pmr_document<SortedKeys> &&doc, detail::file_mapping &&file) noexcept
+            : detail::pmr_document<SortedKeys>{std::move(doc)}, file_{std::move(file)}
+        {
+        }
+
+        // the mapped file
+        [[nodiscard]] auto source() const noexcept -> std::string_view { return file_.view(); }
+
+    private:
+        detail::file_mapping file_;
+    };
+
+    // map `path` read-only and parse it as `Format`; io_error if the file
+    // cannot be opened or mapped
+    template <file_format Format, options Opts = {}>
+    auto load_file(std::filesystem::path const &path,
+                   std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept
+        -> std::variant<mapped_document<Opts.sorted_keys>, parse_error>
+    {
+        detail::file_mapping file;
+        if (!file.open(path.c_str()))
+            return parse_error{error_code::io_error, 0, 0};
+
+        // the document keeps the mapping, so its strings can view it
+        constexpr auto viewing = []
+        {
+            auto o = Opts;
+            o.reference_source = true;
+            return o;
+        }();
+        auto r = [&]
+        {
+            if constexpr (Format == file_format::json)
+                return json::parse<viewing>(file.view(), resource);
+            else if constexpr (Format == file_format::yaml)
+                return yaml::parse<viewing>(file.view(), resource);
+            else if constexpr (Format == file_format::toml)
+                return toml::parse<viewing>(file.view(), resource);
+            else
+                return xml::parse<viewing>(file.view(), resource);
+        }();
+        if (std::holds_alternative<parse_error>(r))
+            return std::get<parse_error>(r);
+        return mapped_document<Opts.sorted_keys>{std::get<0>(std::move(r)), std::move(file)};
+    }
+
+} // namespace data
@@ -0,0 +1,259 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <immutable_data/json.hpp>
+#include <immutable_data/toml.hpp>
+#include <immutable_data/xml.hpp>
+#include <immutable_data/yaml.hpp>
+#include <string>
+
+// --- Document string arena ---
+
+TEST_CASE("decoded strings live in the arena, plain strings reference the input")
+{
+    static constexpr auto doc = data::json::parse_or_throw(R"({"plain": "abc", "esc": "a\nb"})");
+    auto const arena = std::string_view{doc.chars_.data(), doc.chars_size_};
+    CHECK(arena == "a\nb");
+    CHECK(doc.find(doc.root_, "plain")->as_string().data() != arena.data());
+    CHECK(doc.find(doc.root_, "esc")->as_string().data() == arena.data());
+    CHECK(doc.find(doc.root_, "esc")->as_string() == "a\nb");
+}
+
+TEST_CASE("a runtime parse copies plain strings into the arena")
+{
+    auto input = std::string{R"({"plain": "abc", "esc": "a\nb"})"};
+    auto r = data::json::parse(input);
+    REQUIRE(std::holds_alternative<data::detail::document>(r));
+    auto const &doc = std::get<data::detail::document>(r);
+    auto const arena = std::string_view{doc.chars_.data(), doc.chars_size_};
+    auto const plain = doc.find(doc.root_, "plain")->as_string();
+    CHECK(plain == "abc");
+    CHECK(plain.data() >= arena.data());
+    CHECK(plain.data() < arena.data() + arena.size());
+}
+
+TEST_CASE("a document copy reads its own arena")
+{
+    static constexpr auto doc = data::json::parse_or_throw(R"(["x\ty", "plain"])");
+    auto copy = doc;
+    CHECK(copy.at(copy.root_, 0).as_string() == "x\ty");
+    CHECK(copy.at(copy.root_, 0).as_string().data() == copy.chars_.data());
+    CHECK(copy.at(copy.root_, 1).as_string() == "plain");
+}
+
+TEST_CASE("lookups hand out the stored nodes")
+{
+    auto r = data::json::parse(std::string{R"({"s": "a\tb", "list": ["x", "y"]})"});
+    REQUIRE(std::holds_alternative<data::detail::document>(r));
+    auto const &doc = std::get<data::detail::document>(r);
+    auto const &s = *doc.find(doc.root_, "s");
+    data::detail::value const *list = doc.find(doc.root_, "list");
+    data::detail::value const *second = &doc.at(*list, 1);
+    CHECK(&s == doc.find_path("s"));
+    CHECK(second == doc.find_path("list.1"));
+    CHECK(s.as_string() == "a\tb");
+    CHECK(second->as_string() == "y");
+    for (auto [key, val] : doc.entries(doc.root_))
+        CHECK(&val == doc.find(doc.root_, key));
+}
+
+TEST_CASE("a block-scope constexpr document keeps its decoded strings")
+{
+    constexpr auto root = data::json::parse_or_throw(R"("a\nb")");
+    constexpr auto doc = data::json::parse_or_throw(R"({"s": "a\tb"})");
+    CHECK(root.root_.as_string() == "a\nb");
+    CHECK(doc.find(doc.root_, "s")->as_string() == "a\tb");
+    auto copy = root;
+    CHECK(copy.root_.as_string() == "a\nb");
+    CHECK(copy.root_.as_string().data() == copy.chars_.data());
+}
+
+TEST_CASE("a runtime document outlives its input")
+{
+    auto r = data::json::parse(std::string{R"({"name": "gateway", "tags": ["edge", "a\tb"]})"});
+    REQUIRE(std::holds_alternative<data::detail::document>(r));
+    auto const &doc = std::get<data::detail::document>(r);
+    // the input string is gone; every byte read here is the document's own
+    CHECK(doc.find(doc.root_, "name")->as_string() == "gateway");
+    CHECK(doc.find_path("tags.0")->as_string() == "edge");
+    CHECK(doc.find_path("tags.1")->as_string() == "a\tb");
+    CHECK(doc.key_at(doc.root_, 1) == "tags");
+}
+
+TEST_CASE("reference_source views the input instead of copying it")
+{
+    constexpr auto opts = data::options{.reference_source = true};
+    std::string const input = R"({"plain": "abc", "esc": "a\nb"})";
+    auto r = data::json::parse<opts>(input);
+    REQUIRE(std::holds_alternative<data::detail::options_document<opts>>(r));
+    auto const &doc = std::get<data::detail::options_document<opts>>(r);
+    auto const plain = doc.find(doc.root_, "plain")->as_string();
+    CHECK(plain == "abc");
+    CHECK(plain.data() >= input.data());
+    CHECK(plain.data() < input.data() + input.size());
+    CHECK(doc.chars_size_ == 3); // only the decoded "a\nb"
+}
+
+// --- Interned strings ---
+
+TEST_CASE("keys and decoded strings are interned")
+{
+    static constexpr auto doc = data::json::parse_or_throw(R"([
+        {"host": "a\tb", "port": 1},
+        {"host": "a\tb", "port": 2},
+        {"host": "a\tb", "port": 3}
+    ])");
+    CHECK(doc.strings_.size_ == 4); // "", host, port, "a\tb"
+    CHECK(doc.chars_size_ == 3);
+    auto first = doc.find(doc.at(doc.root_, 0), "host");
+    auto last = doc.find(doc.at(doc.root_, 2), "host");
+    REQUIRE(first);
+    REQUIRE(last);
+    CHECK(first->as_string() == "a\tb");
+    CHECK(first->as_string().data() == last->as_string().data());
+    CHECK(doc.key_at(doc.at(doc.root_, 1), 1) == "port");
+    CHECK(doc.find(doc.at(doc.root_, 1), "missing") == nullptr);
+}
+
+using repeated_keys = data::yaml::exact_document<R"(
+- {name: a, port: 1}
+- {name: b, port: 2}
+)">;
+static_assert(repeated_keys::string_capacity == 3, "exact-size string table holds only the distinct keys");
+
+// --- Children staged in the pool ---
+
+TEST_CASE("nested containers keep child order and leave no staged nodes")
+{
+    static constexpr auto doc = data::yaml::parse_or_throw(R"(
+a: [1, [2, 3], 4]
+b:
+  c: x
+  d: [5]
+e: 6
+)");
+    CHECK(doc.top_ == DATA_CT_MAX_NODES);
+    CHECK(doc.key_at(doc.root_, 0) == "a");
+    CHECK(doc.key_at(doc.root_, 2) == "e");
+    auto a = doc.find(doc.root_, "a");
+    REQUIRE(a);
+    CHECK(doc.at(*a, 0).as_int() == 1);
+    CHECK(doc.at(doc.at(*a, 1), 1).as_int() == 3);
+    CHECK(doc.at(*a, 2).as_int() == 4);
+    auto b = doc.find(doc.root_, "b");
+    REQUIRE(b);
+    CHECK(doc.key_at(*b, 1) == "d");
+    CHECK(doc.at(*doc.find(*b, "d"), 0).as_int() == 5);
+}
+
+// --- Perfect-hash mapping index ---
+
+constexpr auto wide = data::json::parse_or_throw(R"({
+    "k00": 0, "k01": 1, "k02": 2, "k03": 3, "k04": 4, "k05": 5, "k06": 6, "k07": 7,
+    "k08": 8, "k09": 9, "k10": 10, "k11": 11, "k12": 12, "k13": 13, "k14": 14, "k15": 15,
+    "k16": 16, "k17": 17, "k18": 18, "k19": 19, "k20": 20, "k21": 21, "k22": 22, "k23": 23,
+    "k24": 24, "k25": 25, "k26": 26, "k27": 27, "k28": 28, "k29": 29, "k30": 30, "k31": 31,
+    "k32": 32, "k33": 33, "k34": 34, "k35": 35, "k36": 36, "k37": 37, "k38": 38, "k39": 39,
+    "inner": {"z": 0}
+})");
+static_assert(wide.root_.size_ != 0, "a 41-key mapping is indexed");
+static_assert([] {
+    constexpr char digits[] = "0123456789";
+    for (std::size_t i = 0; i < 40; ++i)
+    {
+        char key[] = {'k', digits[i / 10], digits[i % 10]};
+        auto const v = wide.find(wide.root_, {key, 3});
+        if (!v || v->as_int() != static_cast<std::int64_t>(i))
+            return false;
+    }
+    // "z" is interned (it keys the nested mapping) so this goes through the index
+    return wide.find(wide.root_, "z") == nullptr && wide.find(wide.root_, "k40") == nullptr;
+}(), "every key is found through the index, absent keys are not");
+
+TEST_CASE("small mappings are scanned, large ones indexed")
+{
+    static constexpr auto doc = data::yaml::parse_or_throw(R"(
+small:
+  a: 1
+  b: 2
+)");
+    auto small = doc.find(doc.root_, "small");
+    REQUIRE(small);
+    CHECK(small->size_ == 0);
+    CHECK(doc.find(*small, "b")->as_int() == 2);
+    CHECK(doc.index_size_ == 0);
+
+    CHECK(wide.index_size_ > 0);
+    CHECK(wide.find(wide.root_, "k17")->as_int() == 17);
+    CHECK(wide.find(wide.root_, "b") == nullptr);
+}
+
+TEST_CASE("exact-size documents keep the index")
+{
+    static constexpr auto doc = data::json::parse_or_throw<R"({
+    "k00": 0, "k01": 1, "k02": 2, "k03": 3, "k04": 4, "k05": 5, "k06": 6, "k07": 7,
+    "k08": 8, "k09": 9, "k10": 10, "k11": 11, "k12": 12, "k13": 13, "k14": 14, "k15": 15,
+    "k16": 16, "k17": 17, "k18": 18, "k19": 19, "k20": 20, "k21": 21, "k22": 22, "k23": 23,
+    "k24": 24, "k25": 25, "k26": 26, "k27": 27, "k28": 28, "k29": 29, "k30": 30, "k31": 31,
+    "k32": 32, "k33": 33, "k34": 34, "k35": 35, "k36": 36, "k37": 37, "k38": 38, "k39": 39,
+    "inner": {"z": 0}
+})">();
+    static_assert(decltype(doc)::index_capacity == wide.index_size_);
+    CHECK(doc.root_.size_ != 0);
+    CHECK(doc.find(doc.root_, "k39")->as_int() == 39);
+    CHECK(doc.find(doc.root_, "k00")->as_int() == 0);
+}
+
+// --- Sorted-key documents ---
+
+constexpr data::options sorted{.sorted_keys = true};
+
+TEST_CASE("sorted-key documents binary-search and iterate in source order")
+{
+    static constexpr auto doc = data::json::parse_or_throw<sorted>(R"({"zeta": 1, "alpha": 2, "mid": {"y": 3, "b": 4}})");
+    static_assert(decltype(doc)::sorted_keys && decltype(doc)::index_capacity == 0);
+    CHECK(doc.find(doc.root_, "alpha")->as_int() == 2);
+    CHECK(doc.find(doc.root_, "zeta")->as_int() == 1);
+    CHECK(doc.find(*doc.find(doc.root_, "mid"), "b")->as_int() == 4);
+    CHECK(doc.find(doc.root_, "y") == nullptr);
+    CHECK(doc.find(doc.root_, "nope") == nullptr);
+
+    std::string_view order[3]{};
+    std::size_t i = 0;
+    for (auto [key, val] : doc.entries(doc.root_))
+        order[i++] = key;
+    CHECK(order[0] == "zeta");
+    CHECK(order[1] == "alpha");
+    CHECK(order[2] == "mid");
+    CHECK(doc.key_at(doc.root_, 1) == "alpha");
+}
+
+TEST_CASE("sorted-key documents report duplicate keys")
+{
+    constexpr auto json = data::json::parse<sorted>(R"({"a": 1, "b": 2, "a": 3})");
+    REQUIRE(std::holds_alternative<data::parse_error>(json));
+    CHECK(std::get<data::parse_error>(json).code == data::error_code::duplicate_key);
+
+    constexpr auto yaml = data::yaml::parse<sorted>("a: 1\nb: 2\na: 3\n");
+    REQUIRE(std::holds_alternative<data::parse_error>(yaml));
+    CHECK(std::get<data::parse_error>(yaml).code == data::error_code::duplicate_key);
+
+    constexpr auto toml = data::toml::parse<sorted>("a = 1\nb = 2\na = 3\n");
+    REQUIRE(std::holds_alternative<data::parse_error>(toml));
+    CHECK(std::get<data::parse_error>(toml).code == data::error_code::duplicate_key);
+
+    constexpr auto xml = data::xml::parse<sorted>("<r><a>1</a><b>2</b><a>3</a></r>");
+    REQUIRE(std::holds_alternative<data::parse_error>(xml));
+    CHECK(std::get<data::parse_error>(xml).code == data::error_code::duplicate_key);
+}
+
+TEST_CASE("exact-size sorted-key documents")
+{
+    constexpr auto doc = data::yaml::parse_or_throw<R"(
+port: 8080
+host: example
+)", sorted>();
+    static_assert(decltype(doc)::sorted_keys && decltype(doc)::node_capacity == 2);
+    CHECK(doc.find(doc.root_, "host")->as_string() == "example");
+    CHECK(doc.find(doc.root_, "port")->as_int() == 8080);
+    CHECK(doc.key_at(doc.root_, 0) == "port");
+}
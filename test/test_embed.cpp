@@ -72,6 +72,7 @@ TEST_CASE("yaml embed: nested")
 TEST_CASE("yaml embed: many items")
 {
     constexpr auto& doc = data::embedded::edge_many_items;
+    static_assert(std::remove_cvref_t<decltype(doc)>::node_capacity == 16, "pool sized to the file");
     CHECK(doc.size(doc.root_) == 16);
     CHECK(doc.find(doc.root_, "item_01")->as_string() == "alpha");
     CHECK(doc.find(doc.root_, "item_08")->as_string() == "hotel");
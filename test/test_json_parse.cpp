@@ -1,6 +1,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include <immutable_data/json.hpp>
+#include <string>
 
 using namespace data::json;
 using namespace data::detail;
@@ -48,6 +49,17 @@ constexpr auto bad = parse(R"({"a": 1, "a": 2})");
 static_assert(std::holds_alternative<data::parse_error>(bad));
 static_assert(std::get<data::parse_error>(bad).code == data::error_code::duplicate_key);
 
+// exact-size documents carry no arena of their own, so escapes work at any scope
+constexpr auto exact = parse_or_throw<R"({"msg": "a\tb", "n": [1, 2]})">();
+static_assert(decltype(exact)::node_capacity == 4);
+static_assert(exact.find(exact.root_, "msg")->as_string() == "a\tb");
+static_assert(exact.get<"msg", std::string_view>() == "a\tb");
+static_assert(exact.get<"n.1", int>() == 2);
+
+constexpr auto calibration = parse_or_throw(R"({"gain": 1.0000001e-3, "offset": -12.75e2})");
+static_assert(calibration.find(calibration.root_, "gain")->as_float() == 1.0000001e-3);
+static_assert(calibration.find(calibration.root_, "offset")->as_float() == -1275.0);
+
 // --- Runtime tests ---
 
 TEST_CASE("json: simple object")
@@ -163,6 +175,21 @@ TEST_CASE("json: error - unterminated string")
     CHECK(err.column == 1);
 }
 
+TEST_CASE("json: error - lexer error after the root value")
+{
+    constexpr auto r = parse(R"({"a": 1} "open)");
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    CHECK(std::get<data::parse_error>(r).code == data::error_code::unterminated_string);
+}
+
+TEST_CASE("json: error - malformed float literal")
+{
+    auto r = data::json::detail::format::parse<data::detail::document>("[1e]");
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    CHECK(std::get<data::parse_error>(r).code == data::error_code::invalid_syntax);
+    CHECK(std::get<data::parse_error>(r).column == 2);
+}
+
 TEST_CASE("json: error_message function")
 {
     CHECK(data::error_message(data::error_code::none) == "no error");
@@ -218,12 +245,48 @@ TEST_CASE("json: unicode escape - 3-byte UTF-8")
     CHECK(static_cast<unsigned char>(sv[2]) == 0x96);
 }
 
+TEST_CASE("json: unicode escape - surrogate pair")
+{
+    // \uD83D\uDE00 = U+1F600 (4-byte UTF-8)
+    constexpr auto doc = parse_or_throw(R"({"ch": "a\uD83D\uDE00b"})");
+    CHECK(doc.find(doc.root_, "ch")->as_string() == "a\xF0\x9F\x98\x80" "b");
+}
+
+TEST_CASE("json: error - invalid escape sequences")
+{
+    constexpr auto r = parse(R"({"k": "ab\qc"})");
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    CHECK(std::get<data::parse_error>(r).code == data::error_code::invalid_escape_sequence);
+    CHECK(std::get<data::parse_error>(r).column == 10);
+    static_assert(!is_valid(R"(["\u12G4"])"), "bad hex digit");
+    static_assert(!is_valid(R"(["\u12"])"), "short \\u");
+    static_assert(!is_valid(R"(["\uD83D"])"), "lone high surrogate");
+    static_assert(!is_valid(R"(["\uDE00\uD83D"])"), "surrogates out of order");
+    static_assert(!is_valid(R"(["\U0001F600"])"), "no \\U in JSON");
+}
+
 TEST_CASE("json: no escapes - fast path")
 {
     constexpr auto doc = parse_or_throw(R"({"plain": "no escapes here"})");
     CHECK(doc.find(doc.root_, "plain")->as_string() == "no escapes here");
 }
 
+TEST_CASE("json: runtime strings decode across chunk boundaries")
+{
+    for (std::size_t len = 0; len < 80; ++len)
+    {
+        std::string body(len, 'x');
+        std::string json = "{\"k\":" + std::string(len % 37, ' ') + "\"" + body + "\\n" + body + "\"}";
+        auto r = data::json::detail::format::parse<data::detail::document>(json);
+        REQUIRE(std::holds_alternative<data::detail::document>(r));
+        auto const &doc = std::get<data::detail::document>(r);
+        CHECK(doc.find(doc.root_, "k")->as_string() == body + "\n" + body);
+    }
+    auto r = data::json::detail::format::parse<data::detail::document>(std::string("[\"") + std::string(70, 'x'));
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    CHECK(std::get<data::parse_error>(r).code == data::error_code::unterminated_string);
+}
+
 TEST_CASE("json: scalar root values")
 {
     constexpr auto num = parse_or_throw(R"(42)");
@@ -241,3 +304,60 @@ TEST_CASE("json: scalar root values")
     constexpr auto n = parse_or_throw(R"(null)");
     CHECK(n.root_.is_null());
 }
+
+TEST_CASE("json: precompiled paths")
+{
+    static constexpr auto doc = parse_or_throw(R"({
+        "services": [{"name": "api", "port": 8080}, {"name": "web", "port": 443}],
+        "a/b": {"m~n": 1},
+        "": 2
+    })");
+
+    constexpr data::path port{"/services/1/port"};
+    static_assert(port.valid() && port.size() == 3);
+    static_assert(doc.resolve(port)->as_int() == 443);
+    CHECK(doc.resolve(port)->as_int() == 443);
+    // the stored node itself, as find() and at() hand it out
+    auto const &node = *doc.resolve(port);
+    CHECK(&node == doc.find(doc.at(*doc.find(doc.root_, "services"), 1), "port"));
+    CHECK(doc.resolve(data::path{""}) == &doc.root_);
+    CHECK(doc.resolve(data::path{"services.0.name"})->as_string() == "api");
+    CHECK(doc.resolve(data::path{"/a~1b/m~0n"})->as_int() == 1);
+    CHECK(doc.resolve(data::path{"/"})->as_int() == 2);
+    CHECK(doc.resolve(data::path{""})->is_mapping());
+
+    CHECK(doc.resolve(data::path{"/services/2/port"}) == nullptr);
+    CHECK(doc.resolve(data::path{"/services/x"}) == nullptr);
+    CHECK(doc.resolve(data::path{"/missing"}) == nullptr);
+
+    CHECK(!data::path{"services..port"}.valid());
+    CHECK(!data::path{"/bad~2escape"}.valid());
+    CHECK(doc.resolve(data::path{"/bad~2escape"}) == nullptr);
+
+    // the path owns its segments, so it can be reused against other documents
+    constexpr auto other = parse_or_throw(R"({"services": [{"port": 1}, {"port": 2}]})");
+    CHECK(other.resolve(port)->as_int() == 2);
+}
+
+TEST_CASE("json: runtime string_view input")
+{
+    std::string const text = R"({"name": "svc", "ports": [80, 443], "note": "a\tb"})";
+    auto const r = parse(text);
+    REQUIRE(std::holds_alternative<document>(r));
+    auto const &doc = std::get<document>(r);
+    CHECK(doc.find(doc.root_, "name")->as_string() == "svc");
+    CHECK(doc.at(*doc.find(doc.root_, "ports"), 1).as_int() == 443);
+    CHECK(doc.find(doc.root_, "note")->as_string() == "a\tb");
+
+    // the same errors, at the same positions, as for a literal
+    auto const dup = parse(std::string{R"({"a": 1, "a": 2})"});
+    REQUIRE(std::holds_alternative<data::parse_error>(dup));
+    CHECK(std::get<data::parse_error>(dup).code == std::get<data::parse_error>(bad).code);
+    CHECK(std::get<data::parse_error>(dup).column == std::get<data::parse_error>(bad).column);
+    CHECK(std::get<data::parse_error>(parse(std::string_view{})).code == data::error_code::invalid_syntax);
+
+    CHECK(is_valid(text));
+    CHECK_THROWS(parse_or_throw(std::string{"[1,"}));
+    auto const sorted = parse_or_throw<data::options{.sorted_keys = true}>(text);
+    CHECK(sorted.find(sorted.root_, "ports")->is_sequence());
+}
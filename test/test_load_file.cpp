@@ -0,0 +1,64 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <immutable_data/load_file.hpp>
+#include <immutable_data/toml.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+// --- Memory-mapped files ---
+
+// a file in the temp directory, removed again at scope exit
+struct temp_file
+{
+    std::filesystem::path path;
+
+    temp_file(char const *name, std::string_view text)
+        : path{std::filesystem::temp_directory_path() / name}
+    {
+        std::ofstream{path, std::ios::binary} << text;
+    }
+    ~temp_file() { std::filesystem::remove(path); }
+};
+
+TEST_CASE("load_file parses a mapped file and views it")
+{
+    temp_file file{"immutable_data_load_file.yaml", "name: gateway\nnote: \"a\\tb\"\nports: [80, 443]\n"};
+    auto r = data::load_file<data::file_format::yaml>(file.path);
+    REQUIRE(std::holds_alternative<data::mapped_document<>>(r));
+    auto const &doc = std::get<data::mapped_document<>>(r);
+    CHECK(doc.find_path("ports.1")->as_int() == 443);
+
+    // plain strings view the mapping, decoded ones live in the arena
+    auto const source = doc.source();
+    auto const name = doc.find(doc.root_, "name")->as_string();
+    CHECK(name == "gateway");
+    CHECK(name.data() >= source.data());
+    CHECK(name.data() < source.data() + source.size());
+    auto const note = doc.find(doc.root_, "note")->as_string();
+    CHECK(note == "a\tb");
+    CHECK((note.data() < source.data() || note.data() >= source.data() + source.size()));
+
+    auto moved = std::move(std::get<data::mapped_document<>>(r));
+    CHECK(moved.find(moved.root_, "name")->as_string() == "gateway");
+}
+
+TEST_CASE("load_file reports unreadable and malformed files")
+{
+    auto missing = data::load_file<data::file_format::json>("/nonexistent/immutable_data.json");
+    REQUIRE(std::holds_alternative<data::parse_error>(missing));
+    CHECK(std::get<data::parse_error>(missing).code == data::error_code::io_error);
+    CHECK(data::error_message(data::error_code::io_error) == "file could not be read");
+
+    temp_file empty{"immutable_data_empty.json", ""};
+    auto nothing = data::load_file<data::file_format::json>(empty.path);
+    REQUIRE(std::holds_alternative<data::parse_error>(nothing));
+    CHECK(std::get<data::parse_error>(nothing).code == data::error_code::invalid_syntax);
+
+    temp_file bad{"immutable_data_bad.toml", "a = 1\na = 2\n"};
+    auto dup = data::load_file<data::file_format::toml>(bad.path);
+    REQUIRE(std::holds_alternative<data::parse_error>(dup));
+    CHECK(std::get<data::parse_error>(dup).code == data::error_code::duplicate_key);
+    // positions match parsing the same text in memory
+    CHECK(std::get<data::parse_error>(dup) == std::get<data::parse_error>(data::toml::parse(std::string_view{"a = 1\na = 2\n"})));
+}
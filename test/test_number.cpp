@@ -0,0 +1,89 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <immutable_data/json.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+// --- Float conversion ---
+
+static_assert(*data::detail::parse_float("0.1") == 0.1);
+static_assert(*data::detail::parse_float("6.02214076e23") == 6.02214076e23);
+static_assert(*data::detail::parse_float("-2.5E-3") == -2.5e-3);
+static_assert(*data::detail::parse_float("1_000.25") == 1000.25);
+static_assert(*data::detail::parse_float("9007199254740993") == 9007199254740992.0, "halfway rounds to even");
+static_assert(*data::detail::parse_float("1.00000000000000011102230246251565404236316680908203125") == 1.0,
+              "halfway past 19 digits goes through the exact fallback");
+static_assert(*data::detail::parse_float("4.9406564584124654e-324") == 4.9406564584124654e-324);
+static_assert(*data::detail::parse_float("1e400") == std::numeric_limits<double>::infinity());
+static_assert(*data::detail::parse_float("1e-400") == 0.0);
+static_assert(!data::detail::parse_float("1e") && !data::detail::parse_float("-") && !data::detail::parse_float("1.5x"));
+
+TEST_CASE("float conversion matches std::from_chars")
+{
+    std::mt19937_64 rng(2024);
+    char buf[64];
+    auto agrees = [](std::string_view s)
+    {
+        double expected = 0;
+        if (std::from_chars(s.data(), s.data() + s.size(), expected).ec != std::errc{})
+            return true; // out of range: from_chars leaves no value to compare
+        auto const got = data::detail::parse_float(s);
+        return got && std::memcmp(&*got, &expected, sizeof expected) == 0;
+    };
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto const bits = rng();
+        double d;
+        std::memcpy(&d, &bits, sizeof d);
+        if (!std::isfinite(d))
+            continue;
+        auto r = std::to_chars(buf, buf + sizeof buf, d);
+        CHECK(agrees({buf, r.ptr}));
+        // more digits than a double holds, to exercise the fallback
+        r = std::to_chars(buf, buf + sizeof buf, d, std::chars_format::scientific, 30);
+        CHECK(agrees({buf, r.ptr}));
+        auto const decimal = std::to_string(rng() % 1000000) + "." + std::to_string(rng() % 1000000) + "e" +
+                             std::to_string(static_cast<int>(rng() % 640) - 320);
+        CHECK(agrees(decimal));
+    }
+}
+
+// --- Integer conversion ---
+
+using data::detail::integer_status;
+static_assert(data::detail::parse_integer("9223372036854775807").value == std::numeric_limits<std::int64_t>::max());
+static_assert(data::detail::parse_integer("-9223372036854775808").value == std::numeric_limits<std::int64_t>::min());
+static_assert(data::detail::parse_integer("000000000000000000000042").value == 42, "leading zeros are not significant");
+static_assert(data::detail::parse_integer("1_000_000").value == 1000000);
+static_assert(data::detail::parse_integer("0x7fff_ffff_ffff_ffff").value == std::numeric_limits<std::int64_t>::max());
+static_assert(data::detail::parse_integer("0o755").value == 0755 && data::detail::parse_integer("0b1010").value == 10);
+static_assert(data::detail::parse_integer("0b102").status == integer_status::invalid);
+static_assert(data::detail::parse_integer("0x").status == integer_status::invalid);
+static_assert(data::detail::parse_integer("-").status == integer_status::invalid);
+static_assert(data::detail::parse_integer("1__2").status == integer_status::invalid);
+static_assert(data::detail::parse_integer("1_").status == integer_status::invalid);
+static_assert(data::detail::parse_integer("_1").status == integer_status::invalid);
+static_assert(data::detail::parse_integer("0x_1").status == integer_status::invalid);
+static_assert(data::detail::parse_integer("0x1F_").status == integer_status::invalid);
+static_assert(data::detail::parse_integer("0b1__0").status == integer_status::invalid);
+static_assert(!data::detail::parse_float("1_.5") && !data::detail::parse_float("1._5") && !data::detail::parse_float("1e5_"));
+
+TEST_CASE("runtime integer conversion agrees at every length")
+{
+    std::mt19937_64 rng(17);
+    for (int i = 0; i < 20000; ++i)
+    {
+        // uniform over digit counts, not values, so short runs are covered
+        auto const v = static_cast<std::int64_t>(rng() >> (1 + rng() % 63));
+        auto const text = std::to_string(i % 2 ? -v : v);
+        auto const r = data::detail::parse_integer(text);
+        REQUIRE(r.status == integer_status::ok);
+        CHECK(r.value == (i % 2 ? -v : v));
+    }
+    CHECK(data::detail::parse_integer("12345678x").status == integer_status::invalid);
+    CHECK(data::detail::parse_integer("99999999999999999999").status == integer_status::overflow);
+}
@@ -0,0 +1,98 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <immutable_data/json.hpp>
+#include <immutable_data/toml.hpp>
+#include <immutable_data/xml.hpp>
+#include <immutable_data/yaml.hpp>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+constexpr data::options sorted{.sorted_keys = true};
+
+// --- Growable pmr documents ---
+
+// the same code reads compile-time and runtime documents
+template <typename Document>
+auto sum_ports(Document const &doc) -> std::int64_t
+{
+    std::int64_t sum = 0;
+    for (auto const &service : doc.values(*doc.resolve(data::path{"/services"})))
+        sum += doc.find(service, data::key{"port"})->as_int();
+    return sum;
+}
+
+TEST_CASE("pmr documents grow past the fixed limits")
+{
+    std::string input = R"({"services": [)";
+    for (int i = 0; i < 2000; ++i)
+        input += (i ? ", " : "") + std::string{R"({"name": "svc\t)"} + std::to_string(i) + R"(", "port": )" + std::to_string(i) + "}";
+    input += "]}";
+
+    auto fixed = data::json::parse(input);
+    REQUIRE(std::holds_alternative<data::parse_error>(fixed));
+    CHECK(std::get<data::parse_error>(fixed).code == data::error_code::pool_overflow);
+
+    std::array<std::byte, 16384> buffer;
+    std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size()};
+    auto r = data::json::parse(input, &resource);
+    REQUIRE(std::holds_alternative<data::json::pmr_document<>>(r));
+    auto const &doc = std::get<data::json::pmr_document<>>(r);
+    CHECK(doc.pool_size_ == 2000 * 2 + 2000 + 1);
+    CHECK(doc.arena_size() > 4096); // decoded names span several arena blocks
+    CHECK(sum_ports(doc) == 1999 * 2000 / 2);
+    CHECK(doc.find(doc.at(*doc.find(doc.root_, "services"), 1234), "name")->as_string() == "svc\t1234");
+    CHECK(doc.find_path("services.1999.name")->as_string() == "svc\t1999");
+
+    static constexpr auto small = data::json::parse_or_throw(R"({"services": [{"port": 1}, {"port": 2}]})");
+    CHECK(sum_ports(small) == 3);
+}
+
+TEST_CASE("pmr documents index and sort mappings like fixed ones")
+{
+    std::pmr::monotonic_buffer_resource resource;
+    std::string input = "{";
+    for (int i = 0; i < 100; ++i)
+        input += (i ? ", \"k" : "\"k") + std::to_string(i) + "\": " + std::to_string(i);
+    input += "}";
+
+    auto indexed = data::json::parse(input, &resource);
+    REQUIRE(std::holds_alternative<data::json::pmr_document<>>(indexed));
+    auto const &doc = std::get<data::json::pmr_document<>>(indexed);
+    CHECK(doc.root_.size_ != 0);
+    CHECK(doc.find(doc.root_, "k73")->as_int() == 73);
+    CHECK(doc.find(doc.root_, "k100") == nullptr);
+
+    auto sorted_doc = data::json::parse<sorted>(input, &resource);
+    REQUIRE(std::holds_alternative<data::json::pmr_document<true>>(sorted_doc));
+    auto const &by_key = std::get<data::json::pmr_document<true>>(sorted_doc);
+    CHECK(by_key.find(by_key.root_, "k5")->as_int() == 5);
+    CHECK(by_key.key_at(by_key.root_, 99) == "k99");
+
+    auto dup = data::yaml::parse<sorted>("a: 1\nb: 2\na: 3\n", &resource);
+    REQUIRE(std::holds_alternative<data::parse_error>(dup));
+    CHECK(std::get<data::parse_error>(dup).code == data::error_code::duplicate_key);
+}
+
+TEST_CASE("pmr documents for every format")
+{
+    std::pmr::unsynchronized_pool_resource resource;
+    auto yaml = data::yaml::parse("a:\n  - \"x\\ty\"\n  - 2\nb: {c: 3}\n", &resource);
+    REQUIRE(std::holds_alternative<data::yaml::pmr_document<>>(yaml));
+    auto const &y = std::get<data::yaml::pmr_document<>>(yaml);
+    CHECK(y.find_path("a.0")->as_string() == "x\ty");
+    CHECK(y.find_path("b.c")->as_int() == 3);
+
+    auto toml = data::toml::parse("[server]\nhost = \"h\\u00e9\"\nports = [1, 2]\n", &resource);
+    REQUIRE(std::holds_alternative<data::toml::pmr_document<>>(toml));
+    auto const &t = std::get<data::toml::pmr_document<>>(toml);
+    CHECK(t.find_path("server.host")->as_string() == "h\xC3\xA9");
+    CHECK(t.find_path("server.ports.1")->as_int() == 2);
+
+    auto xml = data::xml::parse("<r><a>1</a><b> text </b></r>", &resource);
+    REQUIRE(std::holds_alternative<data::xml::pmr_document<>>(xml));
+    auto const &x = std::get<data::xml::pmr_document<>>(xml);
+    CHECK(x.find_path("a")->as_int() == 1);
+    CHECK(x.find_path("b")->as_string() == "text");
+}
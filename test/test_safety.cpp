@@ -5,6 +5,9 @@
 #include <immutable_data/toml.hpp>
 #include <immutable_data/xml.hpp>
 #include <immutable_data/version.hpp>
+#include <array>
+#include <memory_resource>
+#include <string>
 
 // --- Version macros ---
 
@@ -122,6 +125,113 @@ TEST_CASE("document::can_alloc bounds checking")
     CHECK(!doc.can_alloc(DATA_CT_MAX_NODES + 1));
 }
 
+// --- document string arena ---
+
+TEST_CASE("document::can_store bounds checking")
+{
+    data::detail::document doc{};
+    CHECK(doc.can_store(0));
+    CHECK(doc.can_store(DATA_CT_MAX_CHARS));
+    CHECK(!doc.can_store(DATA_CT_MAX_CHARS + 1));
+}
+
+// --- Children staged in the pool ---
+
+TEST_CASE("containers are not limited to DATA_CT_MAX_ITEMS children")
+{
+    static constexpr auto doc = data::json::parse_or_throw(R"([
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+        20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+        40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
+        60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79
+    ])");
+    REQUIRE(doc.size(doc.root_) == 80);
+    for (std::size_t i = 0; i < 80; ++i)
+        CHECK(doc.at(doc.root_, i).as_int() == static_cast<std::int64_t>(i));
+}
+
+TEST_CASE("staging past the pool capacity reports pool_overflow")
+{
+    using small = data::detail::basic_document<4, 0>;
+    constexpr auto r = data::json::detail::format::parse<small>(R"([[1, 2], [3, 4]])");
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    CHECK(std::get<data::parse_error>(r).code == data::error_code::pool_overflow);
+    constexpr auto fits = data::json::detail::format::parse<small>(R"([[1, 2], 3])");
+    REQUIRE(std::holds_alternative<small>(fits));
+    // the root's children are staged right where the pool ends
+    auto const &doc = std::get<small>(fits);
+    CHECK(doc.at(doc.at(doc.root_, 0), 1).as_int() == 2);
+    CHECK(doc.at(doc.root_, 1).as_int() == 3);
+}
+
+// --- Pull lexers ---
+
+TEST_CASE("input size is not bounded by a token buffer")
+{
+    // 2000 values and 1999 commas — far past the old 1024-token buffer
+    std::string json = "[";
+    std::string yaml;
+    std::string toml = "v = [";
+    for (int i = 0; i < 2000; ++i)
+    {
+        json += (i ? ",7" : "7");
+        yaml += "- 7\n";
+        toml += (i ? ",7" : "7");
+    }
+    json += "]";
+    toml += "]";
+
+    using large = data::detail::basic_document<2048, 16>; // room for the copied key "v"
+    static auto const j = data::json::detail::format::parse<large>(json);
+    REQUIRE(std::holds_alternative<large>(j));
+    CHECK(std::get<large>(j).size(std::get<large>(j).root_) == 2000);
+    static auto const y = data::yaml::detail::format::parse<large>(yaml);
+    REQUIRE(std::holds_alternative<large>(y));
+    CHECK(std::get<large>(y).size(std::get<large>(y).root_) == 2000);
+    static auto const t = data::toml::detail::format::parse<large>(toml);
+    REQUIRE(std::holds_alternative<large>(t));
+    auto const &tdoc = std::get<large>(t);
+    CHECK(tdoc.size(*tdoc.find(tdoc.root_, "v")) == 2000);
+}
+
+// --- Integer overflow ---
+
+using data::detail::integer_status;
+static_assert(data::detail::parse_integer("9223372036854775808").status == integer_status::overflow);
+static_assert(data::detail::parse_integer("-9223372036854775809").status == integer_status::overflow);
+static_assert(data::detail::parse_integer("123456789012345678901").status == integer_status::overflow);
+static_assert(data::detail::parse_integer("0x1_0000_0000_0000_0000").status == integer_status::overflow);
+
+constexpr data::options promote{.overflow_to_float = true};
+static_assert(std::get<data::parse_error>(data::json::parse(R"({"id": 18446744073709551616})")).code ==
+              data::error_code::integer_overflow);
+constexpr auto promoted = data::json::parse_or_throw<promote>(R"({"id": 18446744073709551616})");
+static_assert(promoted.find(promoted.root_, "id")->as_float() == 18446744073709551616.0);
+static_assert(std::get<data::parse_error>(data::toml::parse("n = 0x1_0000_0000_0000_0000")).code ==
+              data::error_code::integer_overflow);
+constexpr auto xml_big = data::xml::parse_or_throw("<r><v>99999999999999999999</v></r>");
+static_assert(xml_big.find(xml_big.root_, "v")->is_string(), "xml text past int64 stays text");
+constexpr auto xml_promoted = data::xml::parse_or_throw<promote>("<r><v>99999999999999999999</v></r>");
+static_assert(xml_promoted.find(xml_promoted.root_, "v")->as_float() == 1e20);
+
+// --- pmr resource exhaustion ---
+
+TEST_CASE("an exhausted resource reports overflow")
+{
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    auto r = data::json::parse(R"([1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+        21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+        41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60])", &resource);
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    CHECK(std::get<data::parse_error>(r).code == data::error_code::pool_overflow);
+
+    std::pmr::monotonic_buffer_resource strings{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    auto s = data::json::parse(R"(["a\n"])", &strings);
+    REQUIRE(std::holds_alternative<data::parse_error>(s));
+    CHECK(std::get<data::parse_error>(s).code == data::error_code::string_overflow);
+}
+
 // --- XML depth ---
 
 TEST_CASE("xml: nested elements succeed within limit")
@@ -163,3 +273,5 @@ TEST_CASE("toml: nested inline tables within limit")
 // --- Compile-time validation of safety features ---
 
 static_assert(data::detail::MAX_PARSE_DEPTH == 64, "default depth limit");
+static_assert(sizeof(data::detail::value) == 16, "packed node: 8-byte payload + length + tag + flag");
+static_assert(sizeof(data::detail::pool_entry) == 32, "key reference + packed value");
@@ -0,0 +1,95 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <immutable_data/json.hpp>
+#include <immutable_data/toml.hpp>
+#include <immutable_data/yaml.hpp>
+#include <string>
+
+// --- Character classes ---
+
+static_assert(data::detail::is_class('_', data::detail::char_class::identifier));
+static_assert(!data::detail::is_class('.', data::detail::char_class::identifier));
+static_assert(data::detail::is_class(':', data::detail::char_class::xml_name));
+static_assert(!data::detail::is_class('\r', data::detail::char_class::yaml_space));
+
+TEST_CASE("character class table matches the spelled-out classes")
+{
+    using namespace data::detail;
+    for (int i = 0; i < 256; ++i)
+    {
+        auto const c = static_cast<char>(i);
+        bool const digit = c >= '0' && c <= '9';
+        bool const alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        bool const identifier = digit || alpha || c == '_' || c == '-';
+        CHECK(is_digit(c) == digit);
+        CHECK(is_alpha(c) == alpha);
+        CHECK(is_hex(c) == (digit || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')));
+        CHECK(is_class(c, char_class::identifier) == identifier);
+        CHECK(is_class(c, char_class::xml_name) == (identifier || c == '.' || c == ':'));
+        CHECK(is_class(c, char_class::blank) == (c == ' ' || c == '\t'));
+        CHECK(is_class(c, char_class::yaml_space) == (c == ' ' || c == '\t' || c == '\n'));
+        CHECK(is_class(c, char_class::whitespace) == (c == ' ' || c == '\t' || c == '\n' || c == '\r'));
+    }
+}
+
+// --- Runtime scanners ---
+
+TEST_CASE("simd scanners agree with a byte loop at every offset")
+{
+    std::string text;
+    for (int i = 0; i < 150; ++i)
+        text += "ab \t\"x\\\n   \r"[(i * 7 + i / 5) % 12];
+    std::string_view const in = text;
+    for (std::size_t pos = 0; pos <= in.size(); ++pos)
+    {
+        auto quote = pos;
+        while (quote < in.size() && in[quote] != '"' && in[quote] != '\\')
+            ++quote;
+        CHECK(data::detail::find_quote_or_backslash(in, pos) == quote);
+        auto word = pos;
+        while (word < in.size() && (in[word] == ' ' || in[word] == '\t' || in[word] == '\n' || in[word] == '\r'))
+            ++word;
+        CHECK(data::detail::skip_json_space(in, pos) == word);
+        auto yaml_word = pos;
+        while (yaml_word < in.size() && (in[yaml_word] == ' ' || in[yaml_word] == '\t' || in[yaml_word] == '\n'))
+            ++yaml_word;
+        CHECK(data::detail::skip_yaml_space(in, pos) == yaml_word);
+        auto indent = pos;
+        while (indent < in.size() && in[indent] == ' ')
+            ++indent;
+        CHECK(data::detail::skip_spaces(in, pos) == indent);
+        auto eol = pos;
+        while (eol < in.size() && in[eol] != '\n')
+            ++eol;
+        CHECK(data::detail::find_newline(in, pos) == eol);
+    }
+}
+
+// --- Escape decoding ---
+
+template <typename Format>
+auto decoded(std::string const &input, std::string_view key) -> std::string
+{
+    auto r = Format::template parse<data::detail::document>(input);
+    REQUIRE(std::holds_alternative<data::detail::document>(r));
+    auto const &doc = std::get<data::detail::document>(r);
+    return std::string{doc.find(doc.root_, key)->as_string()};
+}
+
+TEST_CASE("runtime escape decoding copies runs of every length")
+{
+    for (std::size_t len = 0; len < 80; ++len)
+    {
+        std::string const run(len, 'r');
+        // escapes back to back, then after runs either side of a chunk
+        std::string const body = run + "\\t\\u00E9\\\"" + run + "\\\\" + std::string(len % 7, 's') + "\\n";
+        std::string const want = run + "\t\xC3\xA9\"" + run + "\\" + std::string(len % 7, 's') + "\n";
+        CHECK(decoded<data::json::detail::format>("{\"k\": \"" + body + "\"}", "k") == want);
+        CHECK(decoded<data::toml::detail::format>("k = \"" + body + "\"", "k") == want);
+        CHECK(decoded<data::yaml::detail::format>("k: \"" + body + "\"", "k") == want);
+    }
+    auto r = data::json::detail::format::parse<data::detail::document>("[\"" + std::string(70, 'x') + "\\x\"]");
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    CHECK(std::get<data::parse_error>(r).code == data::error_code::invalid_escape_sequence);
+    CHECK(std::get<data::parse_error>(r).column == 73);
+}
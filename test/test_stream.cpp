@@ -0,0 +1,326 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <immutable_data/json.hpp>
+#include <immutable_data/toml.hpp>
+#include <immutable_data/xml.hpp>
+#include <immutable_data/yaml.hpp>
+#include <cstdint>
+#include <memory_resource>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+
+// --- Event streaming ---
+
+// writes each event as a token, e.g. "{ k:a i:1 }"
+struct event_log
+{
+    std::string out;
+
+    auto put(std::string_view tag, std::string_view s = {}) -> void
+    {
+        if (!out.empty())
+            out += ' ';
+        out += tag;
+        out += s;
+    }
+    auto on_begin_mapping() -> void { put("{"); }
+    auto on_end_mapping() -> void { put("}"); }
+    auto on_begin_sequence() -> void { put("["); }
+    auto on_end_sequence() -> void { put("]"); }
+    auto on_key(std::string_view k) -> void { put("k:", k); }
+    auto on_null() -> void { put("~"); }
+    auto on_bool(bool b) -> void { put(b ? "true" : "false"); }
+    auto on_int(std::int64_t i) -> void { put("i:", std::to_string(i)); }
+    auto on_float(double f) -> void { put("f:", std::to_string(static_cast<int>(f * 10))); }
+    auto on_string(std::string_view s) -> void { put("s:", s); }
+};
+
+template <typename Format>
+auto events(std::string_view input) -> std::string
+{
+    event_log log;
+    auto const e = Format::sax_parse(input, log);
+    return e.code == data::error_code::none ? log.out : "error " + std::to_string(static_cast<int>(e.code));
+}
+
+struct json_format { static constexpr auto sax_parse(std::string_view in, auto &h) { return data::json::sax_parse(in, h); } };
+struct yaml_format { static constexpr auto sax_parse(std::string_view in, auto &h) { return data::yaml::sax_parse(in, h); } };
+struct toml_format { static constexpr auto sax_parse(std::string_view in, auto &h) { return data::toml::sax_parse(in, h); } };
+struct xml_format { static constexpr auto sax_parse(std::string_view in, auto &h) { return data::xml::sax_parse(in, h); } };
+
+// only the events it needs, usable in a constant expression
+struct int_sum
+{
+    std::int64_t total = 0;
+    constexpr auto on_int(std::int64_t i) -> void { total += i; }
+};
+
+constexpr auto sum_ints(std::string_view json) -> std::int64_t
+{
+    int_sum sum;
+    return data::json::sax_parse(json, sum).code == data::error_code::none ? sum.total : -1;
+}
+
+TEST_CASE("sax: events arrive in document order")
+{
+    static_assert(sum_ints(R"({"a": [1, 2, {"b": 3}], "c": "4", "d": 10})") == 16);
+    static_assert(sum_ints("[1, 2") == -1);
+
+    CHECK(events<json_format>(R"({"a": [1, 2.5, "x\ty"], "b\n": {}, "c": [], "d": null, "e": true})") ==
+          "{ k:a [ i:1 f:25 s:x\ty ] k:b\n { } k:c [ ] k:d ~ k:e true }");
+    CHECK(events<json_format>("42") == "i:42");
+    CHECK(events<json_format>(R"("\u00e9")") == "s:\xC3\xA9");
+    CHECK(events<json_format>("") == "error 1");
+
+    CHECK(events<yaml_format>("a:\n  - 1\n  - \"q\\tr\"\nb: {c: x, d: [y]}\n") ==
+          "{ k:a [ i:1 s:q\tr ] k:b { k:c s:x k:d [ s:y ] } }");
+    CHECK(events<yaml_format>("- &p 8080\n- *p\n") == "[ i:8080 i:8080 ]");
+
+    CHECK(events<toml_format>("title = \"t\"\n[server]\nhost = \"h\"\nports = [80, 443]\n[db]\n") ==
+          "{ k:title s:t k:server { k:host s:h k:ports [ i:80 i:443 ] } k:db { } }");
+}
+
+TEST_CASE("sax: xml elements become mappings only once they hold something")
+{
+    CHECK(events<xml_format>("<r><a>1</a><b x=\"2\">t</b><c/><d><e>s</e></d></r>") ==
+          "{ k:a i:1 k:b { k:x i:2 k:_text s:t } k:c ~ k:d { k:e s:s } }");
+    CHECK(events<xml_format>("<r> text </r>") == "s:text");
+    CHECK(events<xml_format>("<r><a>x<!-- c -->y</a></r>") == "{ k:a s:xy }");
+}
+
+TEST_CASE("sax: what streaming cannot support is reported")
+{
+    // the anchored container was streamed, so there is nothing to replay
+    CHECK(events<yaml_format>("a: &x [1]\nb: *x\n") ==
+          "error " + std::to_string(static_cast<int>(data::error_code::unsupported_feature)));
+    CHECK(events<yaml_format>("a: &x \"\\t\"\nb: *x\n") ==
+          "error " + std::to_string(static_cast<int>(data::error_code::unsupported_feature)));
+    // no nodes are kept, so duplicate keys go unnoticed
+    CHECK(events<json_format>(R"({"a": 1, "a": 2})") == "{ k:a i:1 k:a i:2 }");
+}
+
+// --- Chunked input ---
+
+// the value as compact text, to compare documents of different types
+template <typename Document>
+auto render(Document const &doc, data::detail::value const &v) -> std::string
+{
+    using kind = data::detail::value::kind;
+    switch (v.kind_)
+    {
+    case kind::null: return "null";
+    case kind::boolean: return v.as_bool() ? "true" : "false";
+    case kind::integer: return std::to_string(v.as_int());
+    case kind::floating: return std::to_string(v.as_float());
+    case kind::string: return '"' + std::string{v.as_string()} + '"';
+    default: break;
+    }
+    std::string out = v.is_mapping() ? "{" : "[";
+    for (std::size_t i = 0; i < doc.size(v); ++i)
+    {
+        if (i)
+            out += ",";
+        if (v.is_mapping())
+            out += std::string{doc.key_at(v, i)} + ":";
+        out += render(doc, doc.at(v, i));
+    }
+    return out + (v.is_mapping() ? "}" : "]");
+}
+
+// feed `text` in chunks of `size` bytes, then end the input
+template <typename Parser>
+auto feed_in_chunks(Parser &p, std::string_view text, std::size_t size) -> data::stream_status
+{
+    for (std::size_t i = 0; i < text.size() && p.status() == data::stream_status::need_more; i += size)
+        p.feed(std::span{text.substr(i, size)});
+    return p.finish();
+}
+
+TEST_CASE("json: stream parser gives the same document for any chunking")
+{
+    std::string_view const text = R"({"name": "café \"x\"", "ports": [80, -443, 1.5e3],
+        "flags": {"on": true, "off": false, "none": null}, "path": "a\\b\/c", "nested": [[], {}, [[1]]]})";
+    auto const whole = data::json::parse(text);
+    REQUIRE(std::holds_alternative<data::detail::document>(whole));
+    auto const expected = render(std::get<data::detail::document>(whole), std::get<data::detail::document>(whole).root_);
+
+    std::pmr::unsynchronized_pool_resource resource;
+    for (std::size_t size = 1; size <= text.size(); ++size)
+    {
+        data::json::stream_parser p{&resource};
+        REQUIRE(feed_in_chunks(p, text, size) == data::stream_status::done);
+        CHECK(render(p.document(), p.document().root_) == expected);
+        CHECK(p.document().find_path("flags.on")->as_bool());
+    }
+}
+
+TEST_CASE("json: stream parser ends at the root value")
+{
+    // a closed root is done at its last byte; what follows is not read
+    data::json::stream_parser p;
+    std::string_view const two = R"({"a": 1} {"b": 2})";
+    CHECK(p.feed(std::span{two}) == data::stream_status::done);
+    CHECK(p.consumed() == 8);
+    CHECK(p.feed(std::span{two}) == data::stream_status::done);
+    CHECK(p.consumed() == 0);
+
+    // a number only ends at the next byte or at finish()
+    data::json::stream_parser n;
+    CHECK(n.feed(std::span{std::string_view{"12"}}) == data::stream_status::need_more);
+    CHECK(n.feed(std::span{std::string_view{"34"}}) == data::stream_status::need_more);
+    CHECK(n.finish() == data::stream_status::done);
+    CHECK(n.document().root_.as_int() == 1234);
+
+    data::json::stream_parser empty;
+    CHECK(empty.finish() == data::stream_status::error);
+    CHECK(empty.error().code == data::error_code::invalid_syntax);
+}
+
+TEST_CASE("json: stream parser reports errors as parse() does")
+{
+    for (std::string_view const text : {"[1, 2", "{\"a\": 1,}", "[1,\n  2,]", "{\"a\" 1}", "[\"a\\qb\"]",
+                                        "[tru]", "{\"a\": 1,\n \"a\": 2}", "\"abc", "[1.e]", "[1 2]", "  ",
+                                        "[\"ab\ncd\\q\"]"})
+    {
+        auto const expected = std::get<data::parse_error>(data::json::parse(text));
+        for (std::size_t size : {std::size_t{1}, std::size_t{3}, text.size()})
+        {
+            data::json::stream_parser p;
+            REQUIRE(feed_in_chunks(p, text, size) == data::stream_status::error);
+            CHECK(p.error() == expected);
+        }
+    }
+
+    std::string deep(data::detail::MAX_PARSE_DEPTH + 1, '[');
+    data::json::stream_parser p;
+    CHECK(p.feed(std::span{std::string_view{deep}}) == data::stream_status::error);
+    CHECK(p.error() == std::get<data::parse_error>(data::json::parse(deep)));
+}
+
+TEST_CASE("json: stream parser reports lexer errors before a duplicate key")
+{
+    // parse() lexes the token after a duplicate key (or after the mapping
+    // whose duplicate only shows when it closes) before it reports the
+    // duplicate, so a token that does not lex wins
+    for (std::string_view const text :
+         {R"({"key": "value", "num": 42, "f": "value", "num": 42, "f:ag": true, "arr": [1, 2, 3]}|)",
+          R"({"key": "value", "num": 42, "f": "value", "num"rrV: 42})", R"({"a": 1, "a" tru})",
+          R"({"a": 1, "a" true})", R"({"a": 1, "a" 5})", R"({"a": 1, "a" "open)", R"({"a": 1, "a")"})
+    {
+        auto const expected = std::get<data::parse_error>(data::json::parse(text));
+        std::mt19937 rng{7};
+        for (int round = 0; round < 20; ++round)
+        {
+            data::json::stream_parser p;
+            if (round == 0)
+            {
+                REQUIRE(feed_in_chunks(p, text, 1) == data::stream_status::error);
+            }
+            else
+            {
+                for (std::size_t i = 0; i < text.size() && p.status() == data::stream_status::need_more;)
+                {
+                    auto const size = std::uniform_int_distribution<std::size_t>{1, 9}(rng);
+                    p.feed(std::span{text.substr(i, size)});
+                    i += size;
+                }
+                REQUIRE(p.finish() == data::stream_status::error);
+            }
+            CHECK(p.error() == expected);
+        }
+    }
+}
+
+TEST_CASE("yaml: stream parser stops at the end of the document")
+{
+    std::string_view const text = "# settings\n---\nserver:\n  host: \"h\\tx\"\n  ports:\n    - 80\n    - 443\n...\nnext: 1\n";
+    std::pmr::unsynchronized_pool_resource resource;
+    for (std::size_t size = 1; size <= text.size(); ++size)
+    {
+        data::yaml::stream_parser p{&resource};
+        auto status = data::stream_status::need_more;
+        std::size_t read = 0;
+        for (std::size_t i = 0; i < text.size() && status == data::stream_status::need_more; i += size)
+        {
+            status = p.feed(std::span{text.substr(i, size)});
+            read = i + p.consumed();
+        }
+        REQUIRE(status == data::stream_status::done);
+        // the "..." line ends it; the next document is left unread
+        CHECK(read == text.find("...") + 3);
+        CHECK(p.document().find_path("server.host")->as_string() == "h\tx");
+        CHECK(p.document().find_path("server.ports.1")->as_int() == 443);
+    }
+}
+
+TEST_CASE("yaml: stream parser settles root entries as lines arrive")
+{
+    // an entry is parsed once a line starts the next one, so its errors
+    // come before the document ends
+    data::yaml::stream_parser p;
+    CHECK(p.feed(std::span{std::string_view{"a: 1\nb: [1,]]\n"}}) == data::stream_status::need_more);
+    CHECK(p.feed(std::span{std::string_view{"c: 3\n"}}) == data::stream_status::error);
+    CHECK(p.error() == std::get<data::parse_error>(data::yaml::parse(std::string_view{"a: 1\nb: [1,]]\nc: 3\n"})));
+
+    data::yaml::stream_parser q;
+    CHECK(q.feed(std::span{std::string_view{"- x\n- *nowhere\n- y\n"}}) == data::stream_status::error);
+    CHECK(q.error().code == data::error_code::cyclic_reference);
+
+    // entries that carry on past the next line at the root's column, and
+    // anchors defined in one entry and used in another
+    std::string_view const texts[] = {
+        "a:\nb: 1\nc: &x [1,\n2]\nd: *x\ne: |\n  one\n\n  two\nf: \"long\nstring\"\n",
+        "- a\n- b: 1\n  c: 2\n-\n- - x\n  - y\n- >\n  folded\n  text\n- {k: v,\nw: z}\n",
+        "k: v\n  - x\nz: 1\n",
+        "a: 1\nb: 2\na: 3\n",
+    };
+    std::pmr::unsynchronized_pool_resource resource;
+    for (auto const text : texts)
+    {
+        auto const whole = data::yaml::parse(text, &resource);
+        for (std::size_t size = 1; size <= text.size(); ++size)
+        {
+            data::yaml::stream_parser s{&resource};
+            feed_in_chunks(s, text, size);
+            if (std::holds_alternative<data::parse_error>(whole))
+            {
+                REQUIRE(s.status() == data::stream_status::error);
+                CHECK(s.error() == std::get<data::parse_error>(whole));
+                continue;
+            }
+            REQUIRE(s.status() == data::stream_status::done);
+            auto const &expected = std::get<0>(whole);
+            CHECK(render(s.document(), s.document().root_) == render(expected, expected.root_));
+        }
+    }
+}
+
+TEST_CASE("yaml: stream parser splits documents and reports errors")
+{
+    // "---" after content starts the next document
+    data::yaml::stream_parser p;
+    std::string_view const two = "a: 1\n---\nb: 2\n";
+    CHECK(p.feed(std::span{two}) == data::stream_status::done);
+    CHECK(p.consumed() == 8);
+    CHECK(p.document().find(p.document().root_, "a")->as_int() == 1);
+    CHECK(p.document().find(p.document().root_, "b") == nullptr);
+
+    // without a marker the document ends with the input
+    data::yaml::stream_parser q;
+    CHECK(q.feed(std::span{std::string_view{"list:\n  - x\n  -"}}) == data::stream_status::need_more);
+    CHECK(q.feed(std::span{std::string_view{" y\n"}}) == data::stream_status::need_more);
+    CHECK(q.finish() == data::stream_status::done);
+    CHECK(q.document().find_path("list.1")->as_string() == "y");
+
+    std::string_view const bad = "a: 1\nb: [1,\n";
+    data::yaml::stream_parser r;
+    CHECK(r.feed(std::span{bad}) == data::stream_status::need_more);
+    CHECK(r.finish() == data::stream_status::error);
+    CHECK(r.error() == std::get<data::parse_error>(data::yaml::parse(bad)));
+
+    data::yaml::stream_parser empty;
+    CHECK(empty.finish() == data::stream_status::error);
+    CHECK(empty.error().code == data::error_code::invalid_syntax);
+}
@@ -1,6 +1,8 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include <immutable_data/toml.hpp>
+#include <limits>
+#include <string>
 
 using namespace data::toml;
 using namespace data::detail;
@@ -57,6 +59,34 @@ name = "second"
 static_assert(std::holds_alternative<data::parse_error>(bad));
 static_assert(std::get<data::parse_error>(bad).code == data::error_code::duplicate_key);
 
+constexpr auto exact = parse_or_throw<R"(
+[server]
+name = "a\nb"
+)">();
+static_assert(decltype(exact)::node_capacity == 2);
+static_assert(exact.find(*exact.find(exact.root_, "server"), "name")->as_string() == "a\nb");
+
+constexpr auto floats = parse_or_throw("big = 6.626_070_15e-34\nup = +inf\nbare = inf\nnot = nan\n");
+static_assert(floats.find(floats.root_, "big")->as_float() == 6.62607015e-34);
+static_assert(floats.find(floats.root_, "up")->as_float() == std::numeric_limits<double>::infinity());
+static_assert(floats.find(floats.root_, "bare")->as_float() == std::numeric_limits<double>::infinity());
+static_assert(floats.find(floats.root_, "not")->is_float());
+
+static_assert(parse_toml_integer("-0x1").status == integer_status::invalid);
+static_assert(parse_toml_integer("+0o7").status == integer_status::invalid);
+static_assert(parse_toml_integer("01").status == integer_status::invalid);
+static_assert(parse_toml_integer("00").status == integer_status::invalid);
+static_assert(parse_toml_integer("-01").status == integer_status::invalid);
+static_assert(parse_toml_integer("0").value == 0 && parse_toml_integer("-0").status == integer_status::ok);
+static_assert(parse_toml_integer("0x1F").value == 31 && parse_toml_integer("-1_000").value == -1000);
+static_assert(!is_valid("n = 01") && !is_valid("n = -0x1") && !is_valid("n = 1__2"));
+
+constexpr auto ints = parse_or_throw("mode = 0o755\nmask = 0xFF_FF\nbits = 0b1010\nbig = 9_223_372_036_854_775_807\n");
+static_assert(ints.find(ints.root_, "mode")->as_int() == 0755);
+static_assert(ints.find(ints.root_, "mask")->as_int() == 0xFFFF);
+static_assert(ints.find(ints.root_, "bits")->as_int() == 10);
+static_assert(ints.find(ints.root_, "big")->as_int() == std::numeric_limits<std::int64_t>::max());
+
 // --- Runtime tests ---
 
 TEST_CASE("toml: simple key-value pairs")
@@ -163,6 +193,20 @@ TEST_CASE("toml: basic string escapes")
     CHECK(doc.find(doc.root_, "msg")->as_string() == "hello\nworld");
 }
 
+TEST_CASE("toml: unicode escapes and escaped keys")
+{
+    constexpr auto doc = parse_or_throw(R"(
+"tab\tkey" = "\u00E9\U0001F600"
+quote = "say \"hi\" \\ bye"
+)");
+    CHECK(doc.find(doc.root_, "tab\tkey")->as_string() == "\xC3\xA9\xF0\x9F\x98\x80");
+    CHECK(doc.find(doc.root_, "quote")->as_string() == "say \"hi\" \\ bye");
+    static_assert(!is_valid(R"(a = "\/")"), "no \\/ in TOML");
+    static_assert(!is_valid(R"(a = "\x41")"), "no \\x in TOML 1.0");
+    static_assert(!is_valid(R"(a = "\UFFFFFFFF")"), "past U+10FFFF");
+    static_assert(!is_valid(R"(a = "\uDFFF")"), "surrogate code point");
+}
+
 TEST_CASE("toml: literal strings (no escape processing)")
 {
     constexpr auto doc = parse_or_throw(R"(path = 'C:\Users\foo')");
@@ -230,3 +274,19 @@ count = 5
     CHECK(doc.find(doc.root_, "key")->as_string() == "value");
     CHECK(doc.find(doc.root_, "count")->as_int() == 5);
 }
+
+TEST_CASE("toml: runtime string_view input")
+{
+    std::string const text = "title = \"runtime\"\n[server]\nport = 0x1F90\n";
+    auto const r = parse(text);
+    REQUIRE(std::holds_alternative<document>(r));
+    auto const &doc = std::get<document>(r);
+    CHECK(doc.find(doc.root_, "title")->as_string() == "runtime");
+    CHECK(doc.find(*doc.find(doc.root_, "server"), "port")->as_int() == 8080);
+
+    auto const dup = parse(std::string{"a = 1\na = 2\n"});
+    REQUIRE(std::holds_alternative<data::parse_error>(dup));
+    CHECK(std::get<data::parse_error>(dup).code == data::error_code::duplicate_key);
+    CHECK(!is_valid(std::string_view{}));
+    CHECK_THROWS(parse_or_throw(std::string{"a = \"open"}));
+}
@@ -1,6 +1,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include <immutable_data/xml.hpp>
+#include <string>
 
 using namespace data::xml;
 using namespace data::detail;
@@ -38,6 +39,13 @@ constexpr auto typed = parse_or_throw(R"(
 </types>
 )");
 
+constexpr auto exact = parse_or_throw<R"(<db port="5432"><host>local<!-- c -->host</host></db>)">();
+static_assert(decltype(exact)::node_capacity == 2);
+static_assert(exact.find(exact.root_, "host")->as_string() == "localhost");
+
+constexpr auto floats = parse_or_throw("<r><v>0.3</v></r>");
+static_assert(floats.find(floats.root_, "v")->as_float() == 0.3);
+
 // --- Runtime tests ---
 
 TEST_CASE("xml: simple element mapping")
@@ -148,6 +156,29 @@ TEST_CASE("xml: comments are skipped")
     CHECK(doc.find(doc.root_, "num")->as_int() == 42);
 }
 
+TEST_CASE("xml: text split by comments and CDATA is joined")
+{
+    constexpr auto doc = parse_or_throw(R"(<root>
+  <plain>  in place  </plain>
+  <joined>
+    left <!-- note -->  right<![CDATA[ <raw> ]]>
+  </joined>
+  <cdata><![CDATA[   ]]></cdata>
+</root>)");
+    auto const plain = doc.find(doc.root_, "plain");
+    CHECK(plain->as_string() == "in place");
+    CHECK(!plain->in_arena_);
+    // whitespace after a comment is dropped, as when parsing
+    CHECK(doc.find(doc.root_, "joined")->as_string() == "left right <raw>");
+    CHECK(doc.find(doc.root_, "cdata")->as_string() == "");
+
+    // split text is not limited to DATA_CT_MAX_STRING_SIZE
+    std::string long_text = "<r><![CDATA[" + std::string(300, 'a') + "]]>" + std::string(300, 'b') + "</r>";
+    auto const r = parse(long_text);
+    REQUIRE(std::holds_alternative<document>(r));
+    CHECK(std::get<document>(r).root_.as_string() == std::string(300, 'a') + std::string(300, 'b'));
+}
+
 TEST_CASE("xml: empty text element")
 {
     constexpr auto doc = parse_or_throw(R"(<root><empty></empty></root>)");
@@ -198,3 +229,17 @@ TEST_CASE("xml: deeply nested")
     REQUIRE(d);
     CHECK(d->as_string() == "deep");
 }
+
+TEST_CASE("xml: runtime string_view input")
+{
+    std::string const text = "<config><name>svc</name><port>8080</port></config>";
+    auto const r = parse(text);
+    REQUIRE(std::holds_alternative<document>(r));
+    auto const &doc = std::get<document>(r);
+    CHECK(doc.find(doc.root_, "name")->as_string() == "svc");
+    CHECK(doc.find(doc.root_, "port")->as_int() == 8080);
+
+    CHECK(!is_valid(std::string_view{}));
+    CHECK(!is_valid(std::string{"<a><b></a>"}));
+    CHECK_THROWS(parse_or_throw(std::string{"<a>"}));
+}
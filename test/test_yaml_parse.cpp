@@ -1,6 +1,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include <immutable_data/yaml.hpp>
+#include <string>
 
 using namespace data::yaml;
 using namespace data::detail;
@@ -60,6 +61,13 @@ constexpr auto bad_result = parse(R"({a: 1, a: 2})");
 static_assert(std::holds_alternative<data::parse_error>(bad_result));
 static_assert(std::get<data::parse_error>(bad_result).code == data::error_code::duplicate_key);
 
+constexpr auto floats = parse_or_throw("tolerance: 2.5e-7\n");
+static_assert(floats.find(floats.root_, "tolerance")->as_float() == 2.5e-7);
+
+constexpr auto ints = parse_or_throw("color: 0xff8800\nperm: 0o644\n");
+static_assert(ints.find(ints.root_, "color")->as_int() == 0xff8800);
+static_assert(ints.find(ints.root_, "perm")->as_int() == 0644);
+
 // --- Runtime tests ---
 
 TEST_CASE("yaml: simple key-value")
@@ -137,6 +145,34 @@ TEST_CASE("yaml: error handling - duplicate key")
     CHECK(std::get<data::parse_error>(bad_result).column > 0);
 }
 
+TEST_CASE("yaml: error handling - lexer error after the root value")
+{
+    constexpr auto r = parse(R"([1, 2]
+key: "open)");
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    CHECK(std::get<data::parse_error>(r).code == data::error_code::unterminated_string);
+}
+
+TEST_CASE("yaml: error positions are found from the token offset")
+{
+    static_assert(sizeof(data::detail::token) == 8);
+    constexpr std::string_view text = "ab\ncd\n\nef";
+    CHECK(data::detail::column_at(text, 0) == 1);
+    CHECK(data::detail::column_at(text, 4) == 2);
+    CHECK(data::detail::column_at(text, 7) == 1);
+    constexpr auto e = data::detail::error_at(text, 8, data::error_code::unexpected_token);
+    CHECK(e.line == 4);
+    CHECK(e.column == 2);
+
+    constexpr auto r = parse(R"(server:
+  host: a
+  host: b)");
+    REQUIRE(std::holds_alternative<data::parse_error>(r));
+    // reported at the ':' after the repeated key
+    CHECK(std::get<data::parse_error>(r).line == 3);
+    CHECK(std::get<data::parse_error>(r).column == 7);
+}
+
 TEST_CASE("yaml: iterate sequence values")
 {
     std::int64_t sum = 0;
@@ -281,6 +317,23 @@ key: >
 )"));
 }
 
+TEST_CASE("yaml: runtime comments and block indentation span chunk boundaries")
+{
+    for (std::size_t width = 1; width < 70; width += 3)
+    {
+        std::string const pad(width, ' ');
+        std::string yaml = "# " + std::string(width * 2, '#') + "\n" + pad + "\n";
+        yaml += pad + "# indented " + std::string(width, 'c') + "\n";
+        yaml += "text: |\n" + pad + "one\n" + pad + "  two  \n\n" + pad + "three\n";
+        yaml += "next: 1 # " + std::string(width, 'c');
+        auto r = data::yaml::detail::format::parse<data::detail::document>(yaml);
+        REQUIRE(std::holds_alternative<data::detail::document>(r));
+        auto const &doc = std::get<data::detail::document>(r);
+        CHECK(doc.find(doc.root_, "text")->as_string() == "one\n  two  \n\nthree");
+        CHECK(doc.find(doc.root_, "next")->as_int() == 1);
+    }
+}
+
 // --- Anchor/alias tests ---
 
 TEST_CASE("yaml: scalar anchor and alias")
@@ -375,3 +428,133 @@ a: &ref value
 b: *ref
 )"));
 }
+
+// --- Exact-size documents ---
+
+constexpr auto exact = parse_or_throw<R"(
+server:
+  host: localhost
+  ports: [80, 443]
+)">();
+static_assert(decltype(exact)::node_capacity == 5);
+static_assert(decltype(exact)::char_capacity == 0);
+static_assert(exact.find(exact.root_, "server")->is_mapping());
+static_assert(sizeof(exact) < sizeof(document));
+
+static_assert(std::holds_alternative<data::parse_error>(parse<R"({a: 1, a: 2})">()));
+static_assert(std::get<data::parse_error>(parse<R"({a: 1, a: 2})">()).code == data::error_code::duplicate_key);
+
+// --- Double-quoted escapes ---
+
+TEST_CASE("yaml: double-quoted scalars decode escapes, single-quoted do not")
+{
+    constexpr auto doc = parse_or_throw(R"(
+"key\ttab": "a\nb\x41\u00E9\L\0"
+nbsp: "\_\N"
+joined: "one \
+    two"
+single: 'C:\dir'
+)");
+    using namespace std::string_view_literals;
+    CHECK(doc.find(doc.root_, "key\ttab")->as_string() == "a\nbA\xC3\xA9\xE2\x80\xA8\0"sv);
+    CHECK(doc.find(doc.root_, "nbsp")->as_string() == "\xC2\xA0\xC2\x85");
+    CHECK(doc.find(doc.root_, "joined")->as_string() == "one two");
+    CHECK(doc.find(doc.root_, "single")->as_string() == "C:\\dir");
+    static_assert(!is_valid(R"(a: "\q")"), "unknown escape");
+    static_assert(!is_valid(R"(a: "\x4")"), "short \\x");
+}
+
+// \L and \P decode longer than their source, even in an exact-size document
+constexpr auto separators = parse_or_throw<R"(["\L\P\L\P\L\P\L\P"])">();
+static_assert(separators.at(separators.root_, 0).as_string().size() == 24);
+
+// --- Compile-time paths ---
+
+constexpr auto service = parse_or_throw(R"(
+server:
+  host: localhost
+  port: 8080
+  timeout: 2.5
+  tls: false
+  listeners:
+    - port: 80
+    - port: 443
+)");
+static_assert(service.get<"server.port", int>() == 8080);
+static_assert(service.get<"server.host", std::string_view>() == "localhost");
+static_assert(service.get<"server.timeout", double>() == 2.5);
+static_assert(service.get<"server.port", double>() == 8080.0);
+static_assert(!service.get<"server.tls", bool>());
+static_assert(service.get<"server.listeners.1.port", std::uint16_t>() == 443);
+static_assert(service.get<"server.listeners">().is_sequence());
+static_assert(exact.get<"server.ports.0", int>() == 80);
+
+static_assert(service.find_path("server.listeners.0.port")->as_int() == 80);
+static_assert(!service.find_path("server.listeners.2.port"));
+static_assert(!service.find_path("server.missing"));
+static_assert(!service.find_path("server..port"));
+static_assert(!service.find_path("server.port.0"));
+
+TEST_CASE("yaml: compile-time path lookup")
+{
+    constexpr auto port = service.get<"server.port", std::int64_t>();
+    CHECK(port == 8080);
+    CHECK(service.find_path("server.host")->as_string() == "localhost");
+    CHECK(service.find_path("server.listeners.1.port")->as_int() == 443);
+    CHECK(service.find_path("") == nullptr);
+}
+
+TEST_CASE("yaml: pre-hashed keys")
+{
+    constexpr data::key port{"port"};
+    constexpr data::key missing{"missing"};
+    static_assert(port.hash() == hash_string("port"));
+    auto server = service.find(service.root_, data::key{"server"});
+    REQUIRE(server);
+    CHECK(service.find(*server, port)->as_int() == 8080);
+    CHECK(service.find(*server, missing) == nullptr);
+    CHECK(service.find(service.root_, port) == nullptr);
+    CHECK(service.find(*service.find(*server, port), port) == nullptr);
+}
+
+TEST_CASE("yaml: exact-size document")
+{
+    auto server = exact.find(exact.root_, "server");
+    REQUIRE(server);
+    CHECK(exact.find(*server, "host")->as_string() == "localhost");
+    auto ports = exact.find(*server, "ports");
+    REQUIRE(ports);
+    CHECK(exact.size(*ports) == 2);
+    CHECK(exact.at(*ports, 1).as_int() == 443);
+}
+
+TEST_CASE("yaml: exact-size document with block scalar at block scope")
+{
+    // decoded strings live in a shared static arena, so no static needed here
+    constexpr auto doc = parse_or_throw<R"(
+text: |
+  line 1
+  line 2
+)">();
+    static_assert(decltype(doc)::node_capacity == 1);
+    static_assert(doc.find(doc.root_, "text")->as_string() == "line 1\nline 2");
+    CHECK(doc.find(doc.root_, "text")->as_string() == "line 1\nline 2");
+}
+
+TEST_CASE("yaml: runtime string_view input")
+{
+    std::string const text = "server:\n  host: \"local\\thost\"\n  ports: [80, 443]\n";
+    auto const r = parse(text);
+    REQUIRE(std::holds_alternative<document>(r));
+    auto const &doc = std::get<document>(r);
+    auto const server = doc.find(doc.root_, "server");
+    REQUIRE(server);
+    CHECK(doc.find(*server, "host")->as_string() == "local\thost");
+    CHECK(doc.at(*doc.find(*server, "ports"), 0).as_int() == 80);
+
+    auto const dup = parse(std::string{"{a: 1, a: 2}"});
+    REQUIRE(std::holds_alternative<data::parse_error>(dup));
+    CHECK(std::get<data::parse_error>(dup).code == data::error_code::duplicate_key);
+    CHECK(!is_valid(std::string_view{}));
+    CHECK_THROWS(parse_or_throw(std::string{"key: \"open"}));
+}